@@ -4,7 +4,7 @@
 use lazy_static::lazy_static;
 use std::sync::Mutex;
 use string_interner::symbol::SymbolU32;
-use string_interner::StringInterner;
+use string_interner::{StringInterner, Symbol};
 
 /// This class implements an interner for Strings.
 /// CBMC objects to have a large number of strings which refer to names: symbols, files, etc.
@@ -46,6 +46,17 @@ pub fn map<T, F: FnOnce(&str) -> T>(&self, f: F) -> T {
     pub fn starts_with(&self, pattern: &str) -> bool {
         self.map(|s| s.starts_with(pattern))
     }
+
+    /// The number of this string in the interner. Strings are numbered from 0 up, in the order
+    /// they were first interned, which makes the number usable as an index.
+    pub fn number(&self) -> usize {
+        self.0.to_usize()
+    }
+
+    /// The interned string with the given `number`
+    pub fn from_number(number: usize) -> InternedString {
+        InternedString(SymbolU32::try_from_usize(number).unwrap())
+    }
 }
 
 impl std::fmt::Display for InternedString {
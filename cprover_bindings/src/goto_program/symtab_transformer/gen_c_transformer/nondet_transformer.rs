@@ -5,6 +5,9 @@
 use crate::goto_program::{Expr, Location, Stmt, Symbol, SymbolTable, Type};
 use std::collections::HashMap;
 
+/// Function provided by `gen_c_lib.c` which fills a buffer with nondeterministic bytes.
+const NONDET_BYTES: &str = "__KANI_nondet_bytes";
+
 /// Struct for handling the nondet transformations for --gen-c-runnable.
 pub struct NondetTransformer {
     new_symbol_table: SymbolTable,
@@ -42,7 +45,8 @@ fn extract_symbol_table(self) -> SymbolTable {
         self.new_symbol_table
     }
 
-    /// Transform nondets to create default values for the expected type.
+    /// Transform nondets to create values for the expected type, which are filled in by
+    /// `__KANI_nondet_bytes` (see `gen_c_lib.c`).
     /// Given: `let x: u32 = __nondet();`
     /// Transformed:
     /// ```
@@ -50,6 +54,7 @@ fn extract_symbol_table(self) -> SymbolTable {
     /// ...
     /// unsigned int non_det_unsigned_bv_32(void) {
     ///     unsigned int ret;
+    ///     __KANI_nondet_bytes(&ret, sizeof(ret));
     ///     return ret;
     /// }
     /// ```
@@ -102,9 +107,24 @@ fn transform_expr_struct(&mut self, typ: &Type, values: &[Expr]) -> Expr {
         )
     }
 
-    /// Create non_det functions which return default value for type.
+    /// Create non_det functions which return a nondeterministic value for type.
     fn postprocess(&mut self) {
-        for (identifier, typ) in self.nondet_types_owned() {
+        let nondet_types = self.nondet_types_owned();
+        if nondet_types.is_empty() {
+            return;
+        }
+
+        // Declare the function that fills in the bytes; its definition lives in `gen_c_lib.c`.
+        let nondet_bytes_typ = Type::code_with_unnamed_parameters(
+            vec![Type::void_pointer(), Type::size_t()],
+            Type::empty(),
+        );
+        let nondet_bytes = Expr::symbol_expression(NONDET_BYTES, nondet_bytes_typ.clone());
+        let nondet_bytes_sym =
+            Symbol::function(NONDET_BYTES, nondet_bytes_typ, None, NONDET_BYTES, Location::none());
+        self.mut_symbol_table().insert(nondet_bytes_sym);
+
+        for (identifier, typ) in nondet_types {
             // Create function body which initializes variable and returns it
             let ret_type = typ.return_type().unwrap();
             assert!(!ret_type.is_empty(), "Cannot generate nondet of type `void`.");
@@ -114,6 +134,16 @@ fn postprocess(&mut self) {
                 vec![
                     // <ret_type> var_ret;
                     Stmt::decl(ret_expr.clone(), None, Location::none()),
+                    // __KANI_nondet_bytes(&var_ret, sizeof(var_ret));
+                    Stmt::function_call(
+                        None,
+                        nondet_bytes.clone(),
+                        vec![
+                            ret_expr.clone().address_of().cast_to(Type::void_pointer()),
+                            ret_type.sizeof_expr(self.symbol_table()),
+                        ],
+                        Location::none(),
+                    ),
                     // return var_ret;
                     Stmt::ret(Some(ret_expr), Location::none()),
                 ],
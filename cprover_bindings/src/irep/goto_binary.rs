@@ -0,0 +1,308 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//! This module writes symbol tables in the binary format of CBMC's goto binaries, so they can be
+//! linked directly by `goto-cc`, without going through a JSON symbol table and `symtab2gb`.
+//!
+//! The format is implemented by CBMC in:
+//! <https://github.com/diffblue/cbmc/blob/develop/src/goto-programs/write_goto_binary.cpp>
+//! <https://github.com/diffblue/cbmc/blob/develop/src/util/irep_serialization.cpp>
+//!
+//! Strings and ireps are written once, and then referred to by number. Strings are numbered by
+//! their `InternedString`, so we share the interner with the rest of the crate. Ireps are numbered
+//! by their id and the numbers of their operands, so equal ireps, e.g. the many copies of a type,
+//! are only written once, even across symbols. Ireps shared in memory are only numbered once.
+//!
+//! Only the symbol table is written. Function bodies are the values of their symbols, as in the
+//! JSON symbol table, and `goto-cc` converts them into goto programs when it links an executable.
+use super::{Irep, IrepId, IrepNode, Symbol};
+use crate::InternedString;
+use std::collections::{BTreeMap, BTreeSet, HashMap};
+use std::io::{self, Write};
+use std::rc::Rc;
+
+/// The first bytes of every goto binary
+const GOTO_BINARY_MAGIC: &[u8] = &[0x7f, b'G', b'B', b'F'];
+/// The version of the format we write
+const GOTO_BINARY_VERSION: usize = 5;
+
+/// Write `symbol_table` to `out` as a goto binary.
+/// Like the JSON serialization, this only converts one symbol to an irep at a time.
+pub fn write_goto_binary(
+    symbol_table: &crate::goto_program::SymbolTable,
+    out: impl Write,
+) -> io::Result<()> {
+    let symbols: Vec<_> = symbol_table.iter().map(|(_, symbol)| symbol).collect();
+    write_symbols(symbol_table, &symbols, out)
+}
+
+/// Write the symbols of `symbol_table` named in `names` to `out` as a goto binary, e.g. the
+/// symbols a harness can reach (see `reachability`). Names without a symbol are skipped.
+pub fn write_goto_binary_of(
+    symbol_table: &crate::goto_program::SymbolTable,
+    names: &BTreeSet<InternedString>,
+    out: impl Write,
+) -> io::Result<()> {
+    let symbols: Vec<_> = names.iter().filter_map(|name| symbol_table.lookup(*name)).collect();
+    write_symbols(symbol_table, &symbols, out)
+}
+
+fn write_symbols(
+    symbol_table: &crate::goto_program::SymbolTable,
+    symbols: &[&crate::goto_program::Symbol],
+    out: impl Write,
+) -> io::Result<()> {
+    let mm = symbol_table.machine_model();
+    let mut writer = GotoBinaryWriter::new(out);
+    writer.out.write_all(GOTO_BINARY_MAGIC)?;
+    writer.write_word(GOTO_BINARY_VERSION)?;
+
+    writer.write_word(symbols.len())?;
+    for symbol in symbols {
+        writer.write_symbol(&symbol.to_irep(mm))?;
+    }
+
+    // The goto functions. We only write their bodies as symbol values.
+    writer.write_word(0)?;
+    writer.out.flush()
+}
+
+struct GotoBinaryWriter<W: Write> {
+    out: W,
+    /// The string numbers of the ids that are not a `FreeformString`
+    id_numbers: BTreeMap<IrepId, usize>,
+    /// Whether each string has been written yet, by number
+    written_strings: Vec<bool>,
+    /// The number of each distinct irep, by key (see `number_irep`)
+    irep_numbers: HashMap<Rc<[usize]>, usize>,
+    /// The key of each irep, by number, and whether the irep has been written yet
+    ireps: Vec<(Rc<[usize]>, bool)>,
+    /// The number of each irep node of the symbol being written, since nodes can be shared
+    node_numbers: HashMap<*const IrepNode, usize>,
+}
+
+impl<W: Write> GotoBinaryWriter<W> {
+    fn new(out: W) -> Self {
+        GotoBinaryWriter {
+            out,
+            id_numbers: BTreeMap::new(),
+            written_strings: Vec::new(),
+            irep_numbers: HashMap::new(),
+            ireps: Vec::new(),
+            node_numbers: HashMap::new(),
+        }
+    }
+
+    /// Write an unsigned integer, 7 bits at a time starting from the least significant ones. The
+    /// top bit of each byte tells whether more bytes follow.
+    fn write_word(&mut self, mut word: usize) -> io::Result<()> {
+        loop {
+            let byte = (word & 0x7f) as u8;
+            word >>= 7;
+            if word == 0 {
+                return self.out.write_all(&[byte]);
+            }
+            self.out.write_all(&[byte | 0x80])?;
+        }
+    }
+
+    /// Write a string terminated by a 0 byte, escaping any 0 and '\' in it with a '\'.
+    fn write_string(&mut self, s: &str) -> io::Result<()> {
+        for byte in s.bytes() {
+            if byte == 0 || byte == b'\\' {
+                self.out.write_all(b"\\")?;
+            }
+            self.out.write_all(&[byte])?;
+        }
+        self.out.write_all(&[0])
+    }
+
+    /// Write the number of a string, and the string itself the first time.
+    fn write_string_ref(&mut self, s: InternedString) -> io::Result<()> {
+        let number = s.number();
+        self.write_word(number)?;
+        if number >= self.written_strings.len() {
+            self.written_strings.resize(number + 1, false);
+        }
+        if !self.written_strings[number] {
+            self.written_strings[number] = true;
+            s.map(|s| self.write_string(s))?;
+        }
+        Ok(())
+    }
+
+    /// The string number of an irep id
+    fn id_number(&mut self, id: &IrepId) -> usize {
+        if let IrepId::FreeformString(s) = id {
+            return s.number();
+        }
+        if let Some(number) = self.id_numbers.get(id) {
+            return *number;
+        }
+        let number = InternedString::from(id.to_string()).number();
+        self.id_numbers.insert(id.clone(), number);
+        number
+    }
+
+    /// Number `irep` and its operands. The key of an irep is the string number of its id, the
+    /// count of its operands and their numbers, followed by the string number and irep number of
+    /// each of its named operands. Equal ireps have equal keys, and so the same number.
+    fn number_irep(&mut self, irep: &Irep) -> usize {
+        let node: *const IrepNode = &**irep;
+        if let Some(number) = self.node_numbers.get(&node) {
+            return *number;
+        }
+        let mut key = Vec::with_capacity(2 + irep.sub.len() + 2 * irep.named_sub.len());
+        key.push(self.id_number(&irep.id));
+        key.push(irep.sub.len());
+        for sub in &irep.sub {
+            key.push(self.number_irep(sub));
+        }
+        for (name, sub) in irep.named_sub.iter() {
+            key.push(self.id_number(name));
+            key.push(self.number_irep(sub));
+        }
+
+        let number = match self.irep_numbers.get(key.as_slice()) {
+            Some(number) => *number,
+            None => {
+                let key: Rc<[usize]> = key.into();
+                let number = self.ireps.len();
+                self.irep_numbers.insert(key.clone(), number);
+                self.ireps.push((key, false));
+                number
+            }
+        };
+        self.node_numbers.insert(node, number);
+        number
+    }
+
+    fn write_irep(&mut self, irep: &Irep) -> io::Result<()> {
+        let number = self.number_irep(irep);
+        self.write_irep_ref(number)
+    }
+
+    /// Write the number of an irep, and the first time, its id followed by its operands, each
+    /// marked with 'S', its named operands, each marked with 'N', and a 0 byte.
+    fn write_irep_ref(&mut self, number: usize) -> io::Result<()> {
+        self.write_word(number)?;
+        let (key, written) = &mut self.ireps[number];
+        if *written {
+            return Ok(());
+        }
+        *written = true;
+        let key = key.clone();
+
+        self.write_string_number(key[0])?;
+        let sub_count = key[1];
+        for &sub in &key[2..2 + sub_count] {
+            self.out.write_all(b"S")?;
+            self.write_irep_ref(sub)?;
+        }
+        for named_sub in key[2 + sub_count..].chunks(2) {
+            self.out.write_all(b"N")?;
+            self.write_string_number(named_sub[0])?;
+            self.write_irep_ref(named_sub[1])?;
+        }
+        self.out.write_all(&[0])
+    }
+
+    /// Like `write_string_ref`, for a string we only know the number of
+    fn write_string_number(&mut self, number: usize) -> io::Result<()> {
+        self.write_string_ref(InternedString::from_number(number))
+    }
+
+    fn write_symbol(&mut self, symbol: &Symbol) -> io::Result<()> {
+        self.write_irep(&symbol.typ)?;
+        self.write_irep(&symbol.value)?;
+        self.write_irep(&symbol.location)?;
+        // The nodes are freed with the symbol, and their addresses reused.
+        self.node_numbers.clear();
+        self.write_string_ref(symbol.name)?;
+        self.write_string_ref(symbol.module)?;
+        self.write_string_ref(symbol.base_name)?;
+        self.write_string_ref(symbol.mode)?;
+        self.write_string_ref(symbol.pretty_name)?;
+        // The obsolete ordering of the symbol
+        self.write_word(0)?;
+
+        // The flags, from the most significant bit down.
+        let flags = [
+            symbol.is_weak,
+            symbol.is_type,
+            symbol.is_property,
+            symbol.is_macro,
+            symbol.is_exported,
+            symbol.is_input,
+            symbol.is_output,
+            symbol.is_state_var,
+            symbol.is_parameter,
+            symbol.is_auxiliary,
+            false, // The obsolete binding of the symbol
+            symbol.is_lvalue,
+            symbol.is_static_lifetime,
+            symbol.is_thread_local,
+            symbol.is_file_local,
+            symbol.is_extern,
+            symbol.is_volatile,
+        ];
+        let flags = flags.iter().fold(0, |bits, flag| (bits << 1) | *flag as usize);
+        self.write_word(flags)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn written(
+        write: impl FnOnce(&mut GotoBinaryWriter<&mut Vec<u8>>) -> io::Result<()>,
+    ) -> Vec<u8> {
+        let mut out = Vec::new();
+        write(&mut GotoBinaryWriter::new(&mut out)).unwrap();
+        out
+    }
+
+    #[test]
+    fn check_write_word() {
+        assert_eq!(written(|w| w.write_word(0)), vec![0]);
+        assert_eq!(written(|w| w.write_word(0x7f)), vec![0x7f]);
+        assert_eq!(written(|w| w.write_word(0x80)), vec![0x80, 0x01]);
+        assert_eq!(written(|w| w.write_word(300)), vec![0xac, 0x02]);
+    }
+
+    #[test]
+    fn check_write_string() {
+        assert_eq!(written(|w| w.write_string("a\\b\0")), b"a\\\\b\\\0\0".to_vec());
+    }
+
+    #[test]
+    fn check_strings_written_once() {
+        let s: InternedString = "goto_binary_string".into();
+        let mut number = Vec::new();
+        GotoBinaryWriter::new(&mut number).write_word(s.number()).unwrap();
+        let out = written(|w| {
+            w.write_string_ref(s)?;
+            w.write_string_ref(s)
+        });
+        let mut expected = number.clone();
+        expected.extend(b"goto_binary_string\0");
+        expected.extend(&number);
+        assert_eq!(out, expected);
+    }
+
+    #[test]
+    fn check_ireps_shared() {
+        let operand = Irep::just_string_id("goto_binary_operand");
+        let irep = Irep::just_sub(vec![operand.clone(), operand]);
+        let mut writer = GotoBinaryWriter::new(Vec::new());
+        writer.write_irep(&irep).unwrap();
+        // The operand and the irep itself
+        assert_eq!(writer.ireps.len(), 2);
+        assert!(writer.ireps.iter().all(|(_, written)| *written));
+
+        // Writing the irep again only writes its number.
+        let before = writer.out.len();
+        writer.write_irep(&irep.clone()).unwrap();
+        assert_eq!(writer.out.len(), before + 1);
+    }
+}
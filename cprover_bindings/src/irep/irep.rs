@@ -8,18 +8,126 @@
 use crate::cbmc_string::InternedString;
 use linear_map::LinearMap;
 use num::BigInt;
-use std::fmt::Debug;
+use std::cell::RefCell;
+use std::collections::HashSet;
+use std::fmt::{self, Debug};
+use std::hash::{Hash, Hasher};
+use std::ops::Deref;
+use std::rc::Rc;
 
 /// The CBMC serialization format for goto-programs.
 /// CBMC implementation code is at:
 /// <https://github.com/diffblue/cbmc/blob/develop/src/util/irep.h>
+///
+/// Like in CBMC, an `Irep` is a reference counted pointer to its node: clones share their
+/// subtrees, which are only copied when they are modified.
+#[derive(Clone)]
+pub struct Irep(Rc<IrepNode>);
+
 #[derive(Clone, Debug, PartialEq)]
-pub struct Irep {
+pub struct IrepNode {
     pub id: IrepId,
     pub sub: Vec<Irep>,
     pub named_sub: LinearMap<IrepId, Irep>,
 }
 
+impl Deref for Irep {
+    type Target = IrepNode;
+
+    fn deref(&self) -> &IrepNode {
+        &self.0
+    }
+}
+
+impl PartialEq for Irep {
+    fn eq(&self, other: &Irep) -> bool {
+        // Shared subtrees are equal without looking at them
+        Rc::ptr_eq(&self.0, &other.0) || self.0 == other.0
+    }
+}
+
+impl Debug for Irep {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        self.0.fmt(f)
+    }
+}
+
+thread_local! {
+    /// The hash-consed ireps of the symbol being converted. See `Irep::hash_consed`.
+    static HASH_CONSED: RefCell<HashSet<Shallow>> = RefCell::new(HashSet::new());
+}
+
+/// An irep compared by its id and by the identity of its operands. If the operands are
+/// hash-consed, this is the same as comparing the ireps, but it does not look at the operands.
+struct Shallow(Irep);
+
+impl PartialEq for Shallow {
+    fn eq(&self, other: &Shallow) -> bool {
+        let (a, b) = (&self.0, &other.0);
+        a.id == b.id
+            && a.sub.len() == b.sub.len()
+            && a.sub.iter().zip(&b.sub).all(|(x, y)| Rc::ptr_eq(&x.0, &y.0))
+            && a.named_sub.len() == b.named_sub.len()
+            && a.named_sub
+                .iter()
+                .zip(b.named_sub.iter())
+                .all(|((xk, xv), (yk, yv))| xk == yk && Rc::ptr_eq(&xv.0, &yv.0))
+    }
+}
+
+impl Eq for Shallow {}
+
+impl Hash for Shallow {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        self.0.id.hash(state);
+        for sub in &self.0.sub {
+            Rc::as_ptr(&sub.0).hash(state);
+        }
+        for (name, sub) in self.0.named_sub.iter() {
+            name.hash(state);
+            Rc::as_ptr(&sub.0).hash(state);
+        }
+    }
+}
+
+/// Replace `irep` by its hash-consed copy, hash-consing its operands first if there is none.
+fn hash_cons(table: &mut HashSet<Shallow>, irep: &mut Irep) {
+    if let Some(shared) = table.get(&Shallow(irep.clone())) {
+        *irep = shared.0.clone();
+        return;
+    }
+    if !irep.is_just_id() {
+        // The node is usually fresh, so this does not copy it.
+        let node = Rc::make_mut(&mut irep.0);
+        node.sub.iter_mut().for_each(|sub| hash_cons(table, sub));
+        node.named_sub.iter_mut().for_each(|(_, sub)| hash_cons(table, sub));
+    }
+    let key = Shallow(irep.clone());
+    match table.get(&key) {
+        Some(shared) => *irep = shared.0.clone(),
+        None => {
+            table.insert(key);
+        }
+    }
+}
+
+/// Hash-consing
+impl Irep {
+    /// The hash-consed copy of this irep. Until `Irep::clear_hash_consed`, equal hash-consed
+    /// ireps share one node, as do their equal subtrees. Types and locations are hash-consed
+    /// as they are converted, since they repeat across most expressions of a function.
+    pub fn hash_consed(mut self) -> Irep {
+        HASH_CONSED.with(|table| hash_cons(&mut table.borrow_mut(), &mut self));
+        self
+    }
+
+    /// Forget the hash-consed ireps, which are freed once they are no longer used.
+    /// Called once the ireps of each symbol are built.
+    pub fn clear_hash_consed() {
+        HASH_CONSED.with(|table| table.borrow_mut().clear());
+    }
+}
+
 /// Getters
 impl Irep {
     pub fn lookup(&self, key: IrepId) -> Option<&Irep> {
@@ -46,7 +154,7 @@ pub fn with_location(self, l: &Location, mm: &MachineModel) -> Self {
 
     pub fn with_named_sub(mut self, key: IrepId, value: Irep) -> Self {
         if !value.is_nil() {
-            self.named_sub.insert(key, value);
+            Rc::make_mut(&mut self.0).named_sub.insert(key, value);
         }
         self
     }
@@ -102,7 +210,7 @@ pub fn just_bitpattern_id<T>(i: T, width: u64, signed: bool) -> Irep
     }
 
     pub fn just_id(id: IrepId) -> Irep {
-        Irep { id, sub: Vec::new(), named_sub: LinearMap::new() }
+        Irep::new(id, Vec::new(), LinearMap::new())
     }
 
     pub fn just_int_id<T>(i: T) -> Irep
@@ -112,7 +220,7 @@ pub fn just_int_id<T>(i: T) -> Irep
         Irep::just_id(IrepId::from_int(i))
     }
     pub fn just_named_sub(named_sub: LinearMap<IrepId, Irep>) -> Irep {
-        Irep { id: IrepId::EmptyString, sub: vec![], named_sub }
+        Irep::new(IrepId::EmptyString, vec![], named_sub)
     }
 
     pub fn just_string_id<T: Into<InternedString>>(s: T) -> Irep {
@@ -120,7 +228,11 @@ pub fn just_string_id<T: Into<InternedString>>(s: T) -> Irep {
     }
 
     pub fn just_sub(sub: Vec<Irep>) -> Irep {
-        Irep { id: IrepId::EmptyString, sub, named_sub: LinearMap::new() }
+        Irep::new(IrepId::EmptyString, sub, LinearMap::new())
+    }
+
+    pub fn new(id: IrepId, sub: Vec<Irep>, named_sub: LinearMap<IrepId, Irep>) -> Irep {
+        Irep(Rc::new(IrepNode { id, sub, named_sub }))
     }
 
     pub fn nil() -> Irep {
@@ -135,3 +247,39 @@ pub fn zero() -> Irep {
         Irep::just_id(IrepId::Id0)
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn pointer_irep() -> Irep {
+        Irep::new(IrepId::Pointer, vec![Irep::just_id(IrepId::Empty)], LinearMap::new())
+            .with_named_sub(IrepId::Width, Irep::just_int_id(64))
+    }
+
+    #[test]
+    fn check_hash_consed_shared() {
+        let a = pointer_irep().hash_consed();
+        let b = pointer_irep().hash_consed();
+        assert!(Rc::ptr_eq(&a.0, &b.0));
+        assert!(Rc::ptr_eq(
+            &a.lookup(IrepId::Width).unwrap().0,
+            &Irep::just_int_id(64).hash_consed().0
+        ));
+
+        Irep::clear_hash_consed();
+        let c = pointer_irep().hash_consed();
+        assert!(!Rc::ptr_eq(&a.0, &c.0));
+        assert_eq!(a, c);
+        Irep::clear_hash_consed();
+    }
+
+    #[test]
+    fn check_copy_on_write() {
+        let a = pointer_irep();
+        let b = a.clone().with_named_sub(IrepId::CTypedef, Irep::just_string_id("ptr"));
+        assert!(a.lookup(IrepId::CTypedef).is_none());
+        assert!(b.lookup(IrepId::CTypedef).is_some());
+        assert!(Rc::ptr_eq(&a.sub[0].0, &b.sub[0].0));
+    }
+}
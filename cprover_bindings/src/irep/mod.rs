@@ -7,21 +7,22 @@
 //! You almost certainly want to create typesafe `goto_program` structures, and use the `to_irep` trait from this module to create canonical ireps from them.
 //! This module also supports getting typesafe `goto_program` structures from an irep, and hence can serve as the intermediate phase in a `goto` to `goto` translator.
 //!
-//! Internally, this module uses the naïve representation of an irep as a node with concrete named and unnamed subtrees.
-//! This representation does not take advantage of the sharing features available for ireps in CBMC to reduce memory usage.
+//! Internally, this module represents an irep as a reference counted node with named and unnamed subtrees, like CBMC does.
+//! Types and locations are hash-consed as they are converted, so each distinct one is only allocated once per symbol.
 //!
 //! TODO: Complete the from-irep trait for remaining data types
 //! TODO: Parser for json symbol tables into the internal irep format
-//! TODO: Investigate memory usage, and consider using sharing to reduce memory usage
 
+pub mod goto_binary;
 mod irep;
 mod irep_id;
+pub mod reachability;
 pub mod serialize;
 mod symbol;
 mod symbol_table;
 mod to_irep;
 
-pub use irep::Irep;
+pub use irep::{Irep, IrepNode};
 pub use irep_id::IrepId;
 pub use symbol::Symbol;
 pub use symbol_table::SymbolTable;
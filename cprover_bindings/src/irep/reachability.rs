@@ -0,0 +1,101 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//! This module finds the symbols a proof harness can reach, so that a goto binary of just those
+//! symbols can be written for it (see `goto_binary::write_goto_binary_of`).
+//!
+//! A symbol refers to another by name: symbol expressions, struct and union tags and the
+//! parameters of code types all carry the name of a symbol as their `identifier`. So the
+//! references are found on the ireps of the symbols, without having to know every expression.
+use super::{Irep, IrepId, IrepNode};
+use crate::goto_program::SymbolTable;
+use crate::InternedString;
+use std::collections::{BTreeSet, HashMap, HashSet};
+
+/// The symbols each symbol of a symbol table refers to. These are computed once, for all the
+/// harnesses of the symbol table.
+pub struct SymbolReferences {
+    references: HashMap<InternedString, Vec<InternedString>>,
+}
+
+impl SymbolReferences {
+    pub fn new(symbol_table: &SymbolTable) -> Self {
+        let mm = symbol_table.machine_model();
+        let references = symbol_table
+            .iter()
+            .map(|(name, symbol)| {
+                let symbol = symbol.to_irep(mm);
+                let mut references = ReferenceCollector::default();
+                references.visit(&symbol.typ);
+                references.visit(&symbol.value);
+                (*name, references.names)
+            })
+            .collect();
+        SymbolReferences { references }
+    }
+
+    /// The symbols reachable from `root`, including itself. Names without a symbol, e.g. the
+    /// functions of the C libraries, are included, so the caller can tell what is undefined.
+    pub fn reachable_from(&self, root: InternedString) -> BTreeSet<InternedString> {
+        let mut reachable = BTreeSet::from([root]);
+        let mut worklist = vec![root];
+        while let Some(name) = worklist.pop() {
+            for reference in self.references.get(&name).into_iter().flatten() {
+                if reachable.insert(*reference) {
+                    worklist.push(*reference);
+                }
+            }
+        }
+        reachable
+    }
+}
+
+/// Collects the names in the `identifier` and `#identifier` of an irep and its operands.
+/// Types and locations are shared between the ireps of a symbol, so each node is visited once.
+#[derive(Default)]
+struct ReferenceCollector {
+    names: Vec<InternedString>,
+    visited: HashSet<*const IrepNode>,
+}
+
+impl ReferenceCollector {
+    fn visit(&mut self, irep: &Irep) {
+        if !self.visited.insert(&**irep) {
+            return;
+        }
+        for (name, sub) in irep.named_sub.iter() {
+            match (name, &sub.id) {
+                (IrepId::Identifier | IrepId::CIdentifier, IrepId::FreeformString(s)) => {
+                    self.names.push(*s)
+                }
+                _ => self.visit(sub),
+            }
+        }
+        for sub in &irep.sub {
+            self.visit(sub);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::linear_map;
+
+    #[test]
+    fn check_reference_collector() {
+        let symbol = |name: &str| {
+            Irep::new(
+                IrepId::Symbol,
+                vec![],
+                linear_map![(IrepId::Identifier, Irep::just_string_id(name))],
+            )
+        };
+        let arg = symbol("arg");
+        let call = Irep::just_sub(vec![symbol("callee"), arg.clone(), arg]);
+        let mut references = ReferenceCollector::default();
+        references.visit(&call);
+        // The second `arg` is the same node as the first.
+        let names: Vec<String> = references.names.iter().map(|name| name.to_string()).collect();
+        assert_eq!(names, vec!["callee", "arg"]);
+    }
+}
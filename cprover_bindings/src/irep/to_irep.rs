@@ -17,25 +17,13 @@ pub trait ToIrep {
 
 /// Utility functions
 fn arguments_irep(arguments: &[Expr], mm: &MachineModel) -> Irep {
-    Irep {
-        id: IrepId::Arguments,
-        sub: arguments.iter().map(|x| x.to_irep(mm)).collect(),
-        named_sub: linear_map![],
-    }
+    Irep::new(IrepId::Arguments, arguments.iter().map(|x| x.to_irep(mm)).collect(), linear_map![])
 }
 fn code_irep(kind: IrepId, ops: Vec<Irep>) -> Irep {
-    Irep {
-        id: IrepId::Code,
-        sub: ops,
-        named_sub: linear_map![(IrepId::Statement, Irep::just_id(kind))],
-    }
+    Irep::new(IrepId::Code, ops, linear_map![(IrepId::Statement, Irep::just_id(kind))])
 }
 fn side_effect_irep(kind: IrepId, ops: Vec<Irep>) -> Irep {
-    Irep {
-        id: IrepId::SideEffect,
-        sub: ops,
-        named_sub: linear_map![(IrepId::Statement, Irep::just_id(kind))],
-    }
+    Irep::new(IrepId::SideEffect, ops, linear_map![(IrepId::Statement, Irep::just_id(kind))])
 }
 fn switch_default_irep(body: &Stmt, mm: &MachineModel) -> Irep {
     code_irep(IrepId::SwitchCase, vec![Irep::nil(), body.to_irep(mm)])
@@ -138,14 +126,14 @@ impl ToIrep for Expr {
     fn to_irep(&self, mm: &MachineModel) -> Irep {
         if let ExprValue::IntConstant(i) = self.value() {
             let width = self.typ().native_width(mm).unwrap();
-            Irep {
-                id: IrepId::Constant,
-                sub: vec![],
-                named_sub: linear_map![(
+            Irep::new(
+                IrepId::Constant,
+                vec![],
+                linear_map![(
                     IrepId::Value,
                     Irep::just_bitpattern_id(i.clone(), width, self.typ().is_signed(mm))
                 )],
-            }
+            )
             .with_location(self.location(), mm)
             .with_type(self.typ(), mm)
         } else {
@@ -158,187 +146,178 @@ impl ToIrep for ExprValue {
     fn to_irep(&self, mm: &MachineModel) -> Irep {
         match self {
             ExprValue::AddressOf(e) => {
-                Irep { id: IrepId::AddressOf, sub: vec![e.to_irep(mm)], named_sub: linear_map![] }
+                Irep::new(IrepId::AddressOf, vec![e.to_irep(mm)], linear_map![])
             }
-            ExprValue::Array { elems } => Irep {
-                id: IrepId::Array,
-                sub: elems.iter().map(|x| x.to_irep(mm)).collect(),
-                named_sub: linear_map![],
-            },
+            ExprValue::Array { elems } => Irep::new(
+                IrepId::Array,
+                elems.iter().map(|x| x.to_irep(mm)).collect(),
+                linear_map![],
+            ),
             ExprValue::ArrayOf { elem } => {
-                Irep { id: IrepId::ArrayOf, sub: vec![elem.to_irep(mm)], named_sub: linear_map![] }
+                Irep::new(IrepId::ArrayOf, vec![elem.to_irep(mm)], linear_map![])
             }
             ExprValue::Assign { left, right } => {
                 side_effect_irep(IrepId::Assign, vec![left.to_irep(mm), right.to_irep(mm)])
             }
-            ExprValue::BinOp { op, lhs, rhs } => Irep {
-                id: op.to_irep_id(),
-                sub: vec![lhs.to_irep(mm), rhs.to_irep(mm)],
-                named_sub: linear_map![],
-            },
-            ExprValue::BoolConstant(c) => Irep {
-                id: IrepId::Constant,
-                sub: vec![],
-                named_sub: linear_map![(
+            ExprValue::BinOp { op, lhs, rhs } => {
+                Irep::new(op.to_irep_id(), vec![lhs.to_irep(mm), rhs.to_irep(mm)], linear_map![])
+            }
+            ExprValue::BoolConstant(c) => Irep::new(
+                IrepId::Constant,
+                vec![],
+                linear_map![(
                     IrepId::Value,
                     if *c { Irep::just_id(IrepId::True) } else { Irep::just_id(IrepId::False) },
                 )],
-            },
-            ExprValue::ByteExtract { e, offset } => Irep {
-                id: if mm.is_big_endian {
+            ),
+            ExprValue::ByteExtract { e, offset } => Irep::new(
+                if mm.is_big_endian {
                     IrepId::ByteExtractBigEndian
                 } else {
                     IrepId::ByteExtractLittleEndian
                 },
-                sub: vec![e.to_irep(mm), Expr::int_constant(*offset, Type::ssize_t()).to_irep(mm)],
-                named_sub: linear_map![],
-            },
-            ExprValue::CBoolConstant(i) => Irep {
-                id: IrepId::Constant,
-                sub: vec![],
-                named_sub: linear_map![(
+                vec![e.to_irep(mm), Expr::int_constant(*offset, Type::ssize_t()).to_irep(mm)],
+                linear_map![],
+            ),
+            ExprValue::CBoolConstant(i) => Irep::new(
+                IrepId::Constant,
+                vec![],
+                linear_map![(
                     IrepId::Value,
                     Irep::just_bitpattern_id(if *i { 1u8 } else { 0 }, mm.bool_width, false)
                 )],
-            },
+            ),
             ExprValue::Dereference(e) => {
-                Irep { id: IrepId::Dereference, sub: vec![e.to_irep(mm)], named_sub: linear_map![] }
+                Irep::new(IrepId::Dereference, vec![e.to_irep(mm)], linear_map![])
             }
             //TODO, determine if there is an endineness problem here
             ExprValue::DoubleConstant(i) => {
                 let c: u64 = i.to_bits();
-                Irep {
-                    id: IrepId::Constant,
-                    sub: vec![],
-                    named_sub: linear_map![(
+                Irep::new(
+                    IrepId::Constant,
+                    vec![],
+                    linear_map![(
                         IrepId::Value,
                         Irep::just_bitpattern_id(c, mm.double_width, false)
                     )],
-                }
+                )
             }
             ExprValue::FloatConstant(i) => {
                 let c: u32 = i.to_bits();
-                Irep {
-                    id: IrepId::Constant,
-                    sub: vec![],
-                    named_sub: linear_map![(
+                Irep::new(
+                    IrepId::Constant,
+                    vec![],
+                    linear_map![(
                         IrepId::Value,
                         Irep::just_bitpattern_id(c, mm.float_width, false)
                     )],
-                }
+                )
             }
             ExprValue::FunctionCall { function, arguments } => side_effect_irep(
                 IrepId::FunctionCall,
                 vec![function.to_irep(mm), arguments_irep(arguments, mm)],
             ),
-            ExprValue::If { c, t, e } => Irep {
-                id: IrepId::If,
-                sub: vec![c.to_irep(mm), t.to_irep(mm), e.to_irep(mm)],
-                named_sub: linear_map![],
-            },
-            ExprValue::Index { array, index } => Irep {
-                id: IrepId::Index,
-                sub: vec![array.to_irep(mm), index.to_irep(mm)],
-                named_sub: linear_map![],
-            },
+            ExprValue::If { c, t, e } => Irep::new(
+                IrepId::If,
+                vec![c.to_irep(mm), t.to_irep(mm), e.to_irep(mm)],
+                linear_map![],
+            ),
+            ExprValue::Index { array, index } => {
+                Irep::new(IrepId::Index, vec![array.to_irep(mm), index.to_irep(mm)], linear_map![])
+            }
             ExprValue::IntConstant(_) => {
                 unreachable!("Should have been processed in previous step")
             }
-            ExprValue::Member { lhs, field } => Irep {
-                id: IrepId::Member,
-                sub: vec![lhs.to_irep(mm)],
-                named_sub: linear_map![
+            ExprValue::Member { lhs, field } => Irep::new(
+                IrepId::Member,
+                vec![lhs.to_irep(mm)],
+                linear_map![
                     (IrepId::CLvalue, Irep::one()),
                     (IrepId::ComponentName, Irep::just_string_id(field.to_string())),
                 ],
-            },
+            ),
             ExprValue::Nondet => side_effect_irep(IrepId::Nondet, vec![]),
-            ExprValue::PointerConstant(0) => Irep {
-                id: IrepId::Constant,
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Value, Irep::just_id(IrepId::NULL))],
-            },
-            ExprValue::PointerConstant(i) => Irep {
-                id: IrepId::Constant,
-                sub: vec![],
-                named_sub: linear_map![(
-                    IrepId::Value,
-                    Irep::just_bitpattern_id(*i, mm.pointer_width, false)
-                )],
-            },
+            ExprValue::PointerConstant(0) => Irep::new(
+                IrepId::Constant,
+                vec![],
+                linear_map![(IrepId::Value, Irep::just_id(IrepId::NULL))],
+            ),
+            ExprValue::PointerConstant(i) => Irep::new(
+                IrepId::Constant,
+                vec![],
+                linear_map![(IrepId::Value, Irep::just_bitpattern_id(*i, mm.pointer_width, false))],
+            ),
             ExprValue::SelfOp { op, e } => side_effect_irep(op.to_irep_id(), vec![e.to_irep(mm)]),
             ExprValue::StatementExpression { statements: ops } => side_effect_irep(
                 IrepId::StatementExpression,
                 vec![Stmt::block(ops.to_vec(), Location::none()).to_irep(mm)],
             ),
-            ExprValue::StringConstant { s } => Irep {
-                id: IrepId::StringConstant,
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Value, Irep::just_string_id(s.to_string()),)],
-            },
-            ExprValue::Struct { values } => Irep {
-                id: IrepId::Struct,
-                sub: values.iter().map(|x| x.to_irep(mm)).collect(),
-                named_sub: linear_map![],
-            },
-            ExprValue::Symbol { identifier } => Irep {
-                id: IrepId::Symbol,
-                sub: vec![],
-                named_sub: linear_map![(
-                    IrepId::Identifier,
-                    Irep::just_string_id(identifier.to_string()),
-                )],
-            },
+            ExprValue::StringConstant { s } => Irep::new(
+                IrepId::StringConstant,
+                vec![],
+                linear_map![(IrepId::Value, Irep::just_string_id(s.to_string()),)],
+            ),
+            ExprValue::Struct { values } => Irep::new(
+                IrepId::Struct,
+                values.iter().map(|x| x.to_irep(mm)).collect(),
+                linear_map![],
+            ),
+            ExprValue::Symbol { identifier } => Irep::new(
+                IrepId::Symbol,
+                vec![],
+                linear_map![(IrepId::Identifier, Irep::just_string_id(identifier.to_string()),)],
+            ),
             ExprValue::Typecast(e) => {
-                Irep { id: IrepId::Typecast, sub: vec![e.to_irep(mm)], named_sub: linear_map![] }
+                Irep::new(IrepId::Typecast, vec![e.to_irep(mm)], linear_map![])
             }
-            ExprValue::Union { value, field } => Irep {
-                id: IrepId::Union,
-                sub: vec![value.to_irep(mm)],
-                named_sub: linear_map![(
-                    IrepId::ComponentName,
-                    Irep::just_string_id(field.to_string()),
-                )],
-            },
-            ExprValue::UnOp { op: UnaryOperator::Bswap, e } => Irep {
-                id: IrepId::Bswap,
-                sub: vec![e.to_irep(mm)],
-                named_sub: linear_map![(IrepId::BitsPerByte, Irep::just_int_id(8u8))],
-            },
+            ExprValue::Union { value, field } => Irep::new(
+                IrepId::Union,
+                vec![value.to_irep(mm)],
+                linear_map![(IrepId::ComponentName, Irep::just_string_id(field.to_string()),)],
+            ),
+            ExprValue::UnOp { op: UnaryOperator::Bswap, e } => Irep::new(
+                IrepId::Bswap,
+                vec![e.to_irep(mm)],
+                linear_map![(IrepId::BitsPerByte, Irep::just_int_id(8u8))],
+            ),
             ExprValue::UnOp { op: UnaryOperator::BitReverse, e } => {
-                Irep { id: IrepId::BitReverse, sub: vec![e.to_irep(mm)], named_sub: linear_map![] }
+                Irep::new(IrepId::BitReverse, vec![e.to_irep(mm)], linear_map![])
+            }
+            ExprValue::UnOp { op: UnaryOperator::CountLeadingZeros { allow_zero }, e } => {
+                Irep::new(
+                    IrepId::CountLeadingZeros,
+                    vec![e.to_irep(mm)],
+                    linear_map![(
+                        IrepId::CBoundsCheck,
+                        if *allow_zero { Irep::zero() } else { Irep::one() }
+                    )],
+                )
+            }
+            ExprValue::UnOp { op: UnaryOperator::CountTrailingZeros { allow_zero }, e } => {
+                Irep::new(
+                    IrepId::CountTrailingZeros,
+                    vec![e.to_irep(mm)],
+                    linear_map![(
+                        IrepId::CBoundsCheck,
+                        if *allow_zero { Irep::zero() } else { Irep::one() }
+                    )],
+                )
             }
-            ExprValue::UnOp { op: UnaryOperator::CountLeadingZeros { allow_zero }, e } => Irep {
-                id: IrepId::CountLeadingZeros,
-                sub: vec![e.to_irep(mm)],
-                named_sub: linear_map![(
-                    IrepId::CBoundsCheck,
-                    if *allow_zero { Irep::zero() } else { Irep::one() }
-                )],
-            },
-            ExprValue::UnOp { op: UnaryOperator::CountTrailingZeros { allow_zero }, e } => Irep {
-                id: IrepId::CountTrailingZeros,
-                sub: vec![e.to_irep(mm)],
-                named_sub: linear_map![(
-                    IrepId::CBoundsCheck,
-                    if *allow_zero { Irep::zero() } else { Irep::one() }
-                )],
-            },
             ExprValue::UnOp { op, e } => {
-                Irep { id: op.to_irep_id(), sub: vec![e.to_irep(mm)], named_sub: linear_map![] }
+                Irep::new(op.to_irep_id(), vec![e.to_irep(mm)], linear_map![])
             }
-            ExprValue::Vector { elems } => Irep {
-                id: IrepId::Vector,
-                sub: elems.iter().map(|x| x.to_irep(mm)).collect(),
-                named_sub: linear_map![],
-            },
+            ExprValue::Vector { elems } => Irep::new(
+                IrepId::Vector,
+                elems.iter().map(|x| x.to_irep(mm)).collect(),
+                linear_map![],
+            ),
         }
     }
 }
 
 impl ToIrep for Location {
     fn to_irep(&self, _mm: &MachineModel) -> Irep {
-        match self {
+        let irep = match self {
             Location::None => Irep::nil(),
             Location::BuiltinFunction { line, function_name } => Irep::just_named_sub(linear_map![
                 (
@@ -373,19 +352,17 @@ fn to_irep(&self, _mm: &MachineModel) -> Irep {
                     (IrepId::PropertyClass, Irep::just_string_id(property_class.to_string()))
                 ])
             }
-        }
+        };
+        // Locations repeat across the statements of a function, so they are shared.
+        irep.hash_consed()
     }
 }
 
 impl ToIrep for Parameter {
     fn to_irep(&self, mm: &MachineModel) -> Irep {
-        Irep {
-            id: IrepId::Parameter,
-            sub: vec![],
-            named_sub: linear_map![(IrepId::Type, self.typ().to_irep(mm))],
-        }
-        .with_named_sub_option(IrepId::CIdentifier, self.identifier().map(Irep::just_string_id))
-        .with_named_sub_option(IrepId::CBaseName, self.base_name().map(Irep::just_string_id))
+        Irep::new(IrepId::Parameter, vec![], linear_map![(IrepId::Type, self.typ().to_irep(mm))])
+            .with_named_sub_option(IrepId::CIdentifier, self.identifier().map(Irep::just_string_id))
+            .with_named_sub_option(IrepId::CBaseName, self.base_name().map(Irep::just_string_id))
     }
 }
 
@@ -479,7 +456,7 @@ fn to_irep(&self, mm: &MachineModel) -> Irep {
 
 impl goto_program::Symbol {
     pub fn to_irep(&self, mm: &MachineModel) -> super::Symbol {
-        super::Symbol {
+        let symbol = super::Symbol {
             typ: self.typ.to_irep(mm),
             value: match &self.value {
                 SymbolValues::Expr(e) => e.to_irep(mm),
@@ -518,7 +495,9 @@ pub fn to_irep(&self, mm: &MachineModel) -> super::Symbol {
             is_parameter: self.is_parameter,
             is_auxiliary: self.is_auxiliary,
             is_weak: self.is_weak,
-        }
+        };
+        Irep::clear_hash_consed();
+        symbol
     }
 }
 
@@ -535,174 +514,168 @@ pub fn to_irep(&self) -> super::SymbolTable {
 
 impl ToIrep for Type {
     fn to_irep(&self, mm: &MachineModel) -> Irep {
-        match self {
+        let irep = match self {
             Type::Array { typ, size } => {
                 //CBMC expects the size to be a signed int constant.
                 let size = Expr::int_constant(*size, Type::ssize_t());
-                Irep {
-                    id: IrepId::Array,
-                    sub: vec![typ.to_irep(mm)],
-                    named_sub: linear_map![(IrepId::Size, size.to_irep(mm))],
-                }
+                Irep::new(
+                    IrepId::Array,
+                    vec![typ.to_irep(mm)],
+                    linear_map![(IrepId::Size, size.to_irep(mm))],
+                )
             }
             //TODO make from_irep that matches this.
-            Type::CBitField { typ, width } => Irep {
-                id: IrepId::CBitField,
-                sub: vec![typ.to_irep(mm)],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(*width))],
-            },
+            Type::CBitField { typ, width } => Irep::new(
+                IrepId::CBitField,
+                vec![typ.to_irep(mm)],
+                linear_map![(IrepId::Width, Irep::just_int_id(*width))],
+            ),
             Type::Bool => Irep::just_id(IrepId::Bool),
-            Type::CInteger(CIntType::Bool) => Irep {
-                id: IrepId::CBool,
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(mm.bool_width))],
-            },
-            Type::CInteger(CIntType::Char) => Irep {
-                id: if mm.char_is_unsigned { IrepId::Unsignedbv } else { IrepId::Signedbv },
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(mm.char_width),)],
-            },
-            Type::CInteger(CIntType::Int) => Irep {
-                id: IrepId::Signedbv,
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(mm.int_width),)],
-            },
-            Type::CInteger(CIntType::SizeT) => Irep {
-                id: IrepId::Unsignedbv,
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(mm.pointer_width),)],
-            },
-            Type::CInteger(CIntType::SSizeT) => Irep {
-                id: IrepId::Signedbv,
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(mm.pointer_width),)],
-            },
-            Type::Code { parameters, return_type } => Irep {
-                id: IrepId::Code,
-                sub: vec![],
-                named_sub: linear_map![
+            Type::CInteger(CIntType::Bool) => Irep::new(
+                IrepId::CBool,
+                vec![],
+                linear_map![(IrepId::Width, Irep::just_int_id(mm.bool_width))],
+            ),
+            Type::CInteger(CIntType::Char) => Irep::new(
+                if mm.char_is_unsigned { IrepId::Unsignedbv } else { IrepId::Signedbv },
+                vec![],
+                linear_map![(IrepId::Width, Irep::just_int_id(mm.char_width),)],
+            ),
+            Type::CInteger(CIntType::Int) => Irep::new(
+                IrepId::Signedbv,
+                vec![],
+                linear_map![(IrepId::Width, Irep::just_int_id(mm.int_width),)],
+            ),
+            Type::CInteger(CIntType::SizeT) => Irep::new(
+                IrepId::Unsignedbv,
+                vec![],
+                linear_map![(IrepId::Width, Irep::just_int_id(mm.pointer_width),)],
+            ),
+            Type::CInteger(CIntType::SSizeT) => Irep::new(
+                IrepId::Signedbv,
+                vec![],
+                linear_map![(IrepId::Width, Irep::just_int_id(mm.pointer_width),)],
+            ),
+            Type::Code { parameters, return_type } => Irep::new(
+                IrepId::Code,
+                vec![],
+                linear_map![
                     (
                         IrepId::Parameters,
                         Irep::just_sub(parameters.iter().map(|x| x.to_irep(mm)).collect()),
                     ),
                     (IrepId::ReturnType, return_type.to_irep(mm)),
                 ],
-            },
+            ),
             Type::Constructor => Irep::just_id(IrepId::Constructor),
-            Type::Double => Irep {
-                id: IrepId::Floatbv,
-                sub: vec![],
-                named_sub: linear_map![
+            Type::Double => Irep::new(
+                IrepId::Floatbv,
+                vec![],
+                linear_map![
                     (IrepId::F, Irep::just_int_id(52)),
                     (IrepId::Width, Irep::just_int_id(64)),
                     (IrepId::CCType, Irep::just_id(IrepId::Double)),
                 ],
-            },
+            ),
             Type::Empty => Irep::just_id(IrepId::Empty),
             // CMBC currently represents these as 0 length arrays.
             Type::FlexibleArray { typ } => {
                 //CBMC expects the size to be a signed int constant.
                 let size = Type::ssize_t().zero();
-                Irep {
-                    id: IrepId::Array,
-                    sub: vec![typ.to_irep(mm)],
-                    named_sub: linear_map![(IrepId::Size, size.to_irep(mm))],
-                }
+                Irep::new(
+                    IrepId::Array,
+                    vec![typ.to_irep(mm)],
+                    linear_map![(IrepId::Size, size.to_irep(mm))],
+                )
             }
-            Type::Float => Irep {
-                id: IrepId::Floatbv,
-                sub: vec![],
-                named_sub: linear_map![
+            Type::Float => Irep::new(
+                IrepId::Floatbv,
+                vec![],
+                linear_map![
                     (IrepId::F, Irep::just_int_id(23)),
                     (IrepId::Width, Irep::just_int_id(32)),
                     (IrepId::CCType, Irep::just_id(IrepId::Float)),
                 ],
-            },
-            Type::IncompleteStruct { tag } => Irep {
-                id: IrepId::Struct,
-                sub: vec![],
-                named_sub: linear_map![
+            ),
+            Type::IncompleteStruct { tag } => Irep::new(
+                IrepId::Struct,
+                vec![],
+                linear_map![
                     (IrepId::Tag, Irep::just_string_id(tag.to_string())),
                     (IrepId::Incomplete, Irep::one()),
                 ],
-            },
-            Type::IncompleteUnion { tag } => Irep {
-                id: IrepId::Union,
-                sub: vec![],
-                named_sub: linear_map![
+            ),
+            Type::IncompleteUnion { tag } => Irep::new(
+                IrepId::Union,
+                vec![],
+                linear_map![
                     (IrepId::Tag, Irep::just_string_id(tag.to_string())),
                     (IrepId::Incomplete, Irep::one()),
                 ],
-            },
+            ),
             Type::InfiniteArray { typ } => {
                 let infinity = Irep::just_id(IrepId::Infinity).with_type(&Type::ssize_t(), mm);
-                Irep {
-                    id: IrepId::Array,
-                    sub: vec![typ.to_irep(mm)],
-                    named_sub: linear_map![(IrepId::Size, infinity)],
-                }
+                Irep::new(
+                    IrepId::Array,
+                    vec![typ.to_irep(mm)],
+                    linear_map![(IrepId::Size, infinity)],
+                )
             }
-            Type::Pointer { typ } => Irep {
-                id: IrepId::Pointer,
-                sub: vec![typ.to_irep(mm)],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(mm.pointer_width),)],
-            },
-            Type::Signedbv { width } => Irep {
-                id: IrepId::Signedbv,
-                sub: vec![],
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(*width))],
-            },
-            Type::Struct { tag, components } => Irep {
-                id: IrepId::Struct,
-                sub: vec![],
-                named_sub: linear_map![
+            Type::Pointer { typ } => Irep::new(
+                IrepId::Pointer,
+                vec![typ.to_irep(mm)],
+                linear_map![(IrepId::Width, Irep::just_int_id(mm.pointer_width),)],
+            ),
+            Type::Signedbv { width } => Irep::new(
+                IrepId::Signedbv,
+                vec![],
+                linear_map![(IrepId::Width, Irep::just_int_id(*width))],
+            ),
+            Type::Struct { tag, components } => Irep::new(
+                IrepId::Struct,
+                vec![],
+                linear_map![
                     (IrepId::Tag, Irep::just_string_id(tag.to_string())),
                     (
                         IrepId::Components,
                         Irep::just_sub(components.iter().map(|x| x.to_irep(mm)).collect()),
                     ),
                 ],
-            },
-            Type::StructTag(name) => Irep {
-                id: IrepId::StructTag,
-                sub: vec![],
-                named_sub: linear_map![(
-                    IrepId::Identifier,
-                    Irep::just_string_id(name.to_string()),
-                )],
-            },
+            ),
+            Type::StructTag(name) => Irep::new(
+                IrepId::StructTag,
+                vec![],
+                linear_map![(IrepId::Identifier, Irep::just_string_id(name.to_string()),)],
+            ),
             Type::TypeDef { name, typ } => typ
                 .to_irep(mm)
                 .with_named_sub(IrepId::CTypedef, Irep::just_string_id(name.to_string())),
 
-            Type::Union { tag, components } => Irep {
-                id: IrepId::Union,
-                sub: vec![],
-                named_sub: linear_map![
+            Type::Union { tag, components } => Irep::new(
+                IrepId::Union,
+                vec![],
+                linear_map![
                     (IrepId::Tag, Irep::just_string_id(tag.to_string())),
                     (
                         IrepId::Components,
                         Irep::just_sub(components.iter().map(|x| x.to_irep(mm)).collect()),
                     ),
                 ],
-            },
-            Type::UnionTag(name) => Irep {
-                id: IrepId::UnionTag,
-                sub: vec![],
-                named_sub: linear_map![(
-                    IrepId::Identifier,
-                    Irep::just_string_id(name.to_string()),
-                )],
-            },
-            Type::Unsignedbv { width } => Irep {
-                id: IrepId::Unsignedbv,
-                sub: Vec::new(),
-                named_sub: linear_map![(IrepId::Width, Irep::just_int_id(*width))],
-            },
-            Type::VariadicCode { parameters, return_type } => Irep {
-                id: IrepId::Code,
-                sub: vec![],
-                named_sub: linear_map![
+            ),
+            Type::UnionTag(name) => Irep::new(
+                IrepId::UnionTag,
+                vec![],
+                linear_map![(IrepId::Identifier, Irep::just_string_id(name.to_string()),)],
+            ),
+            Type::Unsignedbv { width } => Irep::new(
+                IrepId::Unsignedbv,
+                Vec::new(),
+                linear_map![(IrepId::Width, Irep::just_int_id(*width))],
+            ),
+            Type::VariadicCode { parameters, return_type } => Irep::new(
+                IrepId::Code,
+                vec![],
+                linear_map![
                     (
                         IrepId::Parameters,
                         Irep::just_sub(parameters.iter().map(|x| x.to_irep(mm)).collect())
@@ -710,15 +683,17 @@ fn to_irep(&self, mm: &MachineModel) -> Irep {
                     ),
                     (IrepId::ReturnType, return_type.to_irep(mm)),
                 ],
-            },
+            ),
             Type::Vector { typ, size } => {
                 let size = Expr::int_constant(*size, Type::ssize_t());
-                Irep {
-                    id: IrepId::Vector,
-                    sub: vec![typ.to_irep(mm)],
-                    named_sub: linear_map![(IrepId::Size, size.to_irep(mm))],
-                }
+                Irep::new(
+                    IrepId::Vector,
+                    vec![typ.to_irep(mm)],
+                    linear_map![(IrepId::Size, size.to_irep(mm))],
+                )
             }
-        }
+        };
+        // Types repeat across most expressions, so they are shared.
+        irep.hash_consed()
     }
 }
@@ -2,6 +2,9 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 /// Represents the machine specific information necessary to generate an Irep.
 use num::bigint::BigInt;
+
+mod targets;
+
 #[derive(Clone, Debug)]
 pub struct MachineModel {
     /// Is the architecture big endian?
@@ -32,6 +35,15 @@ pub struct MachineModel {
 }
 
 impl MachineModel {
+    /// The machine model of a supported architecture, as generated by `tools/sizeofs`.
+    pub fn for_architecture(architecture: &str) -> Option<MachineModel> {
+        match architecture {
+            "x86_64" => Some(targets::x86_64()),
+            "aarch64" => Some(targets::aarch64()),
+            _ => None,
+        }
+    }
+
     pub fn pointer_width_in_bytes(&self) -> usize {
         self.pointer_width as usize / 8
     }
@@ -65,6 +77,22 @@ fn from(rm: RoundingMode) -> Self {
     }
 }
 
+#[cfg(test)]
+mod tests {
+    use super::MachineModel;
+
+    #[test]
+    fn check_supported_architectures() {
+        for arch in ["x86_64", "aarch64"] {
+            let mm = MachineModel::for_architecture(arch).unwrap();
+            assert_eq!(mm.architecture, arch);
+            assert_eq!(mm.word_size, mm.int_width);
+            assert_eq!(mm.memory_operand_size, mm.int_width / 8);
+        }
+        assert!(MachineModel::for_architecture("riscv64").is_none());
+    }
+}
+
 #[cfg(test)]
 pub mod test_util {
     use super::MachineModel;
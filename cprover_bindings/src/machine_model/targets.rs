@@ -0,0 +1,58 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//! The machine models of the supported targets.
+//! This file is generated by tools/sizeofs/main.cpp; do not edit it by hand.
+
+use super::{MachineModel, RoundingMode};
+
+pub fn x86_64() -> MachineModel {
+    MachineModel {
+        alignment: 1,
+        architecture: "x86_64".to_string(),
+        bool_width: 8,
+        char_is_unsigned: false,
+        char_width: 8,
+        double_width: 64,
+        float_width: 32,
+        int_width: 32,
+        is_big_endian: false,
+        long_double_width: 128,
+        long_int_width: 64,
+        long_long_int_width: 64,
+        memory_operand_size: 4,
+        null_is_zero: true,
+        pointer_width: 64,
+        rounding_mode: RoundingMode::ToNearest,
+        short_int_width: 16,
+        single_width: 32,
+        wchar_t_is_unsigned: false,
+        wchar_t_width: 32,
+        word_size: 32,
+    }
+}
+
+pub fn aarch64() -> MachineModel {
+    MachineModel {
+        alignment: 1,
+        architecture: "aarch64".to_string(),
+        bool_width: 8,
+        char_is_unsigned: false,
+        char_width: 8,
+        double_width: 64,
+        float_width: 32,
+        int_width: 32,
+        is_big_endian: false,
+        long_double_width: 64,
+        long_int_width: 64,
+        long_long_int_width: 64,
+        memory_operand_size: 4,
+        null_is_zero: true,
+        pointer_width: 64,
+        rounding_mode: RoundingMode::ToNearest,
+        short_int_width: 16,
+        single_width: 32,
+        wchar_t_is_unsigned: false,
+        wchar_t_width: 32,
+        word_size: 32,
+    }
+}
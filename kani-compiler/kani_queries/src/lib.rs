@@ -16,8 +16,14 @@ pub trait UserInput {
     fn set_output_pretty_json(&mut self, pretty_json: bool);
     fn get_output_pretty_json(&self) -> bool;
 
+    fn set_write_goto_binary(&mut self, goto_binary: bool);
+    fn get_write_goto_binary(&self) -> bool;
+
     fn set_ignore_global_asm(&mut self, global_asm: bool);
     fn get_ignore_global_asm(&self) -> bool;
+
+    fn set_slice_harnesses(&mut self, slice: bool);
+    fn get_slice_harnesses(&self) -> bool;
 }
 
 #[derive(Debug, Default)]
@@ -26,7 +32,9 @@ pub struct QueryDb {
     emit_vtable_restrictions: AtomicBool,
     symbol_table_passes: Vec<String>,
     json_pretty_print: AtomicBool,
+    write_goto_binary: AtomicBool,
     ignore_global_asm: AtomicBool,
+    slice_harnesses: AtomicBool,
 }
 
 impl UserInput for QueryDb {
@@ -62,6 +70,14 @@ fn get_output_pretty_json(&self) -> bool {
         self.json_pretty_print.load(Ordering::Relaxed)
     }
 
+    fn set_write_goto_binary(&mut self, goto_binary: bool) {
+        self.write_goto_binary.store(goto_binary, Ordering::Relaxed);
+    }
+
+    fn get_write_goto_binary(&self) -> bool {
+        self.write_goto_binary.load(Ordering::Relaxed)
+    }
+
     fn set_ignore_global_asm(&mut self, global_asm: bool) {
         self.ignore_global_asm.store(global_asm, Ordering::Relaxed);
     }
@@ -69,4 +85,12 @@ fn set_ignore_global_asm(&mut self, global_asm: bool) {
     fn get_ignore_global_asm(&self) -> bool {
         self.ignore_global_asm.load(Ordering::Relaxed)
     }
+
+    fn set_slice_harnesses(&mut self, slice: bool) {
+        self.slice_harnesses.store(slice, Ordering::Relaxed);
+    }
+
+    fn get_slice_harnesses(&self) -> bool {
+        self.slice_harnesses.load(Ordering::Relaxed)
+    }
 }
@@ -294,6 +294,7 @@ fn create_proof_harness(&mut self, other_attributes: Vec<(String, &Attribute)>)
         for attr in other_attributes.iter() {
             match attr.0.as_str() {
                 "unwind" => self.handle_kanitool_unwind(attr.1, &mut harness),
+                "vec_capacity" => self.handle_kanitool_vec_capacity(attr.1, &mut harness),
                 _ => {
                     self.tcx.sess.span_err(
                         attr.1.span,
@@ -318,6 +319,9 @@ fn default_kanitool_proof(&mut self) -> HarnessMetadata {
             original_file: loc.filename().unwrap(),
             original_line: loc.line().unwrap().to_string(),
             unwind_value: None,
+            vec_capacity: None,
+            goto_file: None,
+            undefined_functions: Vec::new(),
         }
     }
 
@@ -349,6 +353,25 @@ fn handle_kanitool_unwind(&mut self, attr: &Attribute, harness: &mut HarnessMeta
             }
         }
     }
+
+    /// Updates the proof harness with the bound on the initial capacity of the "c-ffi" Vec
+    fn handle_kanitool_vec_capacity(&mut self, attr: &Attribute, harness: &mut HarnessMetadata) {
+        if harness.vec_capacity.is_some() {
+            self.tcx.sess.span_err(attr.span, "Only one '#[kani::vec_capacity]' allowed");
+            return;
+        }
+        match extract_integer_argument(attr).map(u32::try_from) {
+            Some(Ok(capacity)) => harness.vec_capacity = Some(capacity),
+            Some(Err(_)) => {
+                self.tcx.sess.span_err(attr.span, "Value above maximum permitted value - u32::MAX");
+            }
+            None => {
+                self.tcx
+                    .sess
+                    .span_err(attr.span, "Exactly one Vec capacity Argument as Integer accepted");
+            }
+        }
+    }
 }
 
 /// If the attribute is named `kanitool::name`, this extracts `name`
@@ -5,9 +5,11 @@
 
 use crate::codegen_cprover_gotoc::GotocCtx;
 use bitflags::_core::any::Any;
-use cbmc::goto_program::{symtab_transformer, Location};
+use cbmc::goto_program::{symtab_transformer, Location, SymbolTable};
+use cbmc::irep::goto_binary::{write_goto_binary, write_goto_binary_of};
+use cbmc::irep::reachability::SymbolReferences;
 use cbmc::InternedString;
-use kani_metadata::KaniMetadata;
+use kani_metadata::{HarnessMetadata, KaniMetadata};
 use kani_queries::{QueryDb, UserInput};
 use rustc_codegen_ssa::traits::CodegenBackend;
 use rustc_codegen_ssa::{CodegenResults, CrateInfo};
@@ -148,14 +150,27 @@ fn codegen_crate<'tcx>(
             None
         };
 
-        let metadata = KaniMetadata { proof_harnesses: c.proof_harnesses };
+        // Functions without a body, which the driver may find in the C libraries.
+        let undefined_functions = symtab
+            .iter()
+            .filter(|(_, symbol)| symbol.typ.is_code() && symbol.value.is_none())
+            .map(|(name, _)| name.to_string())
+            .collect();
+        let mut metadata = KaniMetadata { proof_harnesses: c.proof_harnesses, undefined_functions };
 
         // No output should be generated if user selected no_codegen.
         if !tcx.sess.opts.unstable_opts.no_codegen && tcx.sess.opts.output_types.should_codegen() {
             let outputs = tcx.output_filenames(());
             let base_filename = outputs.output_path(OutputType::Object);
             let pretty = self.queries.get_output_pretty_json();
-            write_file(&base_filename, "symtab.json", &symtab, pretty);
+            if self.queries.get_write_goto_binary() {
+                write_goto_binary_file(&base_filename, "symtab.out", &symtab);
+            } else {
+                write_file(&base_filename, "symtab.json", &symtab, pretty);
+            }
+            if self.queries.get_slice_harnesses() {
+                write_harness_slices(&base_filename, &symtab, &mut metadata.proof_harnesses);
+            }
             write_file(&base_filename, "type_map.json", &type_map, pretty);
             write_file(&base_filename, "kani-metadata.json", &metadata, pretty);
             // If they exist, write out vtable virtual call function pointer restrictions
@@ -298,6 +313,40 @@ fn write_file<T>(base_filename: &Path, extension: &str, source: &T, pretty: bool
     }
 }
 
+fn write_goto_binary_file(base_filename: &Path, extension: &str, symtab: &SymbolTable) {
+    let filename = base_filename.with_extension(extension);
+    debug!("output to {:?}", filename);
+    let out_file = ::std::fs::File::create(&filename).unwrap();
+    let writer = BufWriter::new(out_file);
+    write_goto_binary(symtab, writer).unwrap();
+}
+
+/// Write the symbols each harness can reach to a goto binary of its own, and record it in the
+/// metadata of the harness, along with the functions it reaches that have no body. The references
+/// between symbols are only found once, for all the harnesses.
+fn write_harness_slices(
+    base_filename: &Path,
+    symtab: &SymbolTable,
+    harnesses: &mut [HarnessMetadata],
+) {
+    let references = SymbolReferences::new(symtab);
+    for (index, harness) in harnesses.iter_mut().enumerate() {
+        let reachable = references.reachable_from(harness.mangled_name.as_str().into());
+        harness.undefined_functions = reachable
+            .iter()
+            .filter_map(|name| symtab.lookup(*name))
+            .filter(|symbol| symbol.typ.is_code() && symbol.value.is_none())
+            .map(|symbol| symbol.name.to_string())
+            .collect();
+
+        let filename = base_filename.with_extension(format!("symtab.harness{}.out", index));
+        debug!("output to {:?}", filename);
+        let writer = BufWriter::new(::std::fs::File::create(&filename).unwrap());
+        write_goto_binary_of(symtab, &reachable, writer).unwrap();
+        harness.goto_file = Some(filename.to_string_lossy().into_owned());
+    }
+}
+
 /// Prints a report at the end of the compilation.
 fn print_report<'tcx>(ctx: &GotocCtx, tcx: TyCtxt<'tcx>) {
     // Print all unsupported constructs.
@@ -20,7 +20,7 @@
 use cbmc::goto_program::{DatatypeComponent, Expr, Location, Stmt, Symbol, SymbolTable, Type};
 use cbmc::utils::aggr_tag;
 use cbmc::InternedString;
-use cbmc::{MachineModel, RoundingMode};
+use cbmc::MachineModel;
 use kani_metadata::HarnessMetadata;
 use kani_queries::{QueryDb, UserInput};
 use rustc_data_structures::owning_ref::OwningRef;
@@ -386,91 +386,11 @@ fn machine_model_from_session(sess: &Session) -> MachineModel {
         Endian::Big => true,
     };
 
-    // The values below cannot be obtained from the session so they are
-    // hardcoded using standard ones for the supported platforms
-    // see /tools/sizeofs/main.cpp.
-    // For reference, the definition in CBMC:
-    //https://github.com/diffblue/cbmc/blob/develop/src/util/config.cpp
-    match architecture.as_ref() {
-        "x86_64" => {
-            let bool_width = 8;
-            let char_is_unsigned = false;
-            let char_width = 8;
-            let double_width = 64;
-            let float_width = 32;
-            let int_width = 32;
-            let long_double_width = 128;
-            let long_int_width = 64;
-            let long_long_int_width = 64;
-            let short_int_width = 16;
-            let single_width = 32;
-            let wchar_t_is_unsigned = false;
-            let wchar_t_width = 32;
-
-            MachineModel {
-                architecture: architecture.to_string(),
-                alignment,
-                bool_width,
-                char_is_unsigned,
-                char_width,
-                double_width,
-                float_width,
-                int_width,
-                is_big_endian,
-                long_double_width,
-                long_int_width,
-                long_long_int_width,
-                memory_operand_size: int_width / 8,
-                null_is_zero: true,
-                pointer_width,
-                rounding_mode: RoundingMode::ToNearest,
-                short_int_width,
-                single_width,
-                wchar_t_is_unsigned,
-                wchar_t_width,
-                word_size: int_width,
-            }
-        }
-        "aarch64" => {
-            let bool_width = 8;
-            let char_is_unsigned = true;
-            let char_width = 8;
-            let double_width = 64;
-            let float_width = 32;
-            let int_width = 32;
-            let long_double_width = 64;
-            let long_int_width = 64;
-            let long_long_int_width = 64;
-            let short_int_width = 16;
-            let single_width = 32;
-            let wchar_t_is_unsigned = false;
-            let wchar_t_width = 32;
-
-            MachineModel {
-                architecture: architecture.to_string(),
-                alignment,
-                bool_width,
-                char_is_unsigned,
-                char_width,
-                double_width,
-                float_width,
-                int_width,
-                is_big_endian,
-                long_double_width,
-                long_int_width,
-                long_long_int_width,
-                memory_operand_size: int_width / 8,
-                null_is_zero: true,
-                pointer_width,
-                rounding_mode: RoundingMode::ToNearest,
-                short_int_width,
-                single_width,
-                wchar_t_is_unsigned,
-                wchar_t_width,
-                word_size: int_width,
-            }
-        }
-        _ => {
+    // The values below cannot be obtained from the session so they are taken
+    // from the models of the supported platforms generated by /tools/sizeofs/main.cpp.
+    match MachineModel::for_architecture(architecture) {
+        Some(mm) => MachineModel { alignment, is_big_endian, pointer_width, ..mm },
+        None => {
             panic!("Unsupported architecture: {}", architecture);
         }
     }
@@ -89,6 +89,8 @@ fn main() -> Result<(), &'static str> {
     queries.set_emit_vtable_restrictions(matches.is_present(parser::RESTRICT_FN_PTRS));
     queries.set_check_assertion_reachability(matches.is_present(parser::ASSERTION_REACH_CHECKS));
     queries.set_output_pretty_json(matches.is_present(parser::PRETTY_OUTPUT_FILES));
+    queries.set_write_goto_binary(matches.is_present(parser::WRITE_GOTO_BINARY));
+    queries.set_slice_harnesses(matches.is_present(parser::SLICE_HARNESSES));
     queries.set_ignore_global_asm(matches.is_present(parser::IGNORE_GLOBAL_ASM));
 
     // Generate rustc args.
@@ -34,6 +34,12 @@
 /// Option name used to use json pretty-print for output files.
 pub const PRETTY_OUTPUT_FILES: &str = "pretty-json-files";
 
+/// Option name used to write the symbol table as a goto binary instead of JSON.
+pub const WRITE_GOTO_BINARY: &str = "write-goto-binary";
+
+/// Option name used to write a goto binary of the symbols each harness can reach.
+pub const SLICE_HARNESSES: &str = "slice-harnesses";
+
 /// Option used for suppressing global ASM error.
 pub const IGNORE_GLOBAL_ASM: &str = "ignore-global-asm";
 
@@ -138,6 +144,16 @@ pub fn parser<'a, 'b>() -> App<'a, 'b> {
                 .long("--pretty-json-files")
                 .help("Output json files in a more human-readable format (with spaces)."),
         )
+        .arg(
+            Arg::with_name(WRITE_GOTO_BINARY)
+                .long("--write-goto-binary")
+                .help("Write the symbol table as a goto binary (symtab.out) instead of JSON."),
+        )
+        .arg(
+            Arg::with_name(SLICE_HARNESSES)
+                .long("--slice-harnesses")
+                .help("Also write a goto binary of the symbols each harness can reach."),
+        )
         .arg(
             Arg::with_name(IGNORE_GLOBAL_ASM)
                 .long("--ignore-global-asm")
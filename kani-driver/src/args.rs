@@ -127,6 +127,42 @@ pub struct KaniArgs {
     #[structopt(long, default_value = "std", possible_values = &AbstractionType::variants(),
     case_insensitive = true, hidden = true)]
     pub abs_type: AbstractionType,
+    /// Grow Vectors of the "c-ffi" abstraction with realloc instead of preallocating a single
+    /// backing object and only moving their capacity within it
+    #[structopt(long, hidden = true)]
+    pub c_ffi_vec_realloc: bool,
+    /// Back the memory of the "c-ffi" abstraction with unbounded arrays. They need a CBMC that
+    /// translates `__CPROVER_constant_infinity_uint` correctly
+    /// (https://github.com/diffblue/cbmc/issues/6261)
+    #[structopt(long, hidden = true)]
+    pub c_ffi_unbounded_arrays: bool,
+    /// Give every Vector of the "c-ffi" abstraction a nondeterministic initial capacity, bounded by
+    /// the `#[kani::vec_capacity]` attribute of the harness, and allocate exactly that capacity
+    #[structopt(long, hidden = true)]
+    pub c_ffi_symbolic_capacity: bool,
+
+    /// Make kani-compiler write goto binaries instead of JSON symbol tables, which then don't
+    /// need to be translated by symtab2gb.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(
+        long,
+        hidden_short_help(true),
+        requires("enable-unstable"),
+        conflicts_with("gen-c")
+    )]
+    pub write_goto_binary: bool,
+
+    /// Have kani-compiler write a goto binary of just what each harness can reach, and link the
+    /// binary of each harness from it, rather than from everything every harness can reach.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(
+        long,
+        hidden_short_help(true),
+        requires("enable-unstable"),
+        // The restrictions name call sites in functions that a slice may not have.
+        conflicts_with("restrict-vtable")
+    )]
+    pub slice_harnesses: bool,
 
     /// Enable extra pointer checks such as invalid pointers in relation operations and pointer
     /// arithmetic overflow.
@@ -151,9 +187,97 @@ pub struct KaniArgs {
     #[structopt(long, hidden_short_help(true), requires("enable-unstable"))]
     pub ignore_global_asm: bool,
 
+    /// Instead of verifying, compile harnesses to native code (using the C generated with
+    /// `gen_c_lib.c`) and run them repeatedly with random values for nondeterministic inputs.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(
+        long,
+        hidden_short_help(true),
+        requires("enable-unstable"),
+        conflicts_with("visualize")
+    )]
+    pub run_native: bool,
+    /// Number of randomized iterations per harness with --run-native [default: 1000]
+    #[structopt(long, requires("run-native"))]
+    pub native_iterations: Option<u64>,
+    /// Seed of the first iteration with --run-native. A failure reports the seed that reproduces it
+    #[structopt(long, requires("run-native"))]
+    pub native_seed: Option<u64>,
+
+    /// Report, for the functions that contribute most to the formula of each harness, the number
+    /// of steps symbolic execution took in them and the number of SSA steps they generated.
+    /// This runs symbolic execution a second time. It is unstable and requires `--enable-unstable`
+    #[structopt(long, hidden_short_help(true), requires("enable-unstable"))]
+    pub profile_functions: bool,
+
+    /// Verify up to this many harnesses at a time, or as many as there are CPUs with `--jobs 0`
+    /// [default: 1]. The harnesses expected to take longest start first, and the results of each
+    /// harness are printed together once it finishes
+    #[structopt(long, short = "j", conflicts_with_all(&["visualize", "run-native"]))]
+    pub jobs: Option<usize>,
+
+    /// Reuse the results of harnesses whose instrumented goto binary and CBMC flags are the same as
+    /// in an earlier run that used this cache directory.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(long, parse(from_os_str), hidden_short_help(true), requires("enable-unstable"))]
+    pub verification_cache: Option<PathBuf>,
+
+    /// Record the cost of verifying each harness in this file, and use it in later runs: to start
+    /// the most expensive harnesses first, to only run the `--solver-portfolio` configuration that
+    /// finished first, and to warn about harnesses that got much slower.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(long, parse(from_os_str), hidden_short_help(true), requires("enable-unstable"))]
+    pub perf_history: Option<PathBuf>,
+
+    /// Verify each harness with several CBMC configurations at once: MiniSat, CaDiCaL and Z3, and
+    /// MiniSat without `--slice-formula`. The first to finish gives the results, and the others
+    /// are stopped. This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(
+        long,
+        hidden_short_help(true),
+        requires("enable-unstable"),
+        conflicts_with("visualize")
+    )]
+    pub solver_portfolio: bool,
+
+    /// Stop at the first failed check: CBMC stops at the first property that fails, the other
+    /// harnesses being verified are stopped, and no other harness is started.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(long, hidden_short_help(true), requires("enable-unstable"))]
+    pub fail_fast: bool,
+
+    /// Only start verifying a harness while the processes Kani started, and the memory that the
+    /// harnesses being verified took in `--perf-history`, fit in this many MiB. This lets `--jobs`
+    /// use all cores on harnesses that need a lot of memory. Harnesses with no recorded memory are
+    /// verified one at a time until a run of CBMC has been measured.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(long, hidden_short_help(true), requires("enable-unstable"))]
+    pub memory_budget: Option<u64>,
+
+    /// Stop CBMC once it uses more than this many MiB on a harness, and report that the harness
+    /// ran out of memory. This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(
+        long,
+        hidden_short_help(true),
+        requires("enable-unstable"),
+        conflicts_with("solver-portfolio")
+    )]
+    pub harness_memory_limit: Option<u64>,
+
     /// Execute CBMC's sanity checks to ensure the goto-program we generate is correct.
     #[structopt(long, hidden_short_help(true), requires("enable-unstable"))]
     pub run_sanity_checks: bool,
+
+    /// Trust that the alignments passed to the allocator are valid, as `Layout` guarantees, and
+    /// don't check them. Unsafe code that builds an invalid `Layout` then goes unnoticed.
+    /// This feature is unstable and it requires `--enable-unstable` to be used
+    #[structopt(
+        long,
+        hidden = true,
+        requires("enable-unstable"),
+        conflicts_with("run-sanity-checks")
+    )]
+    pub trust_layout: bool,
     /*
     The below is a "TODO list" of things not yet implemented from the kani_flags.py script.
 
@@ -175,6 +299,15 @@ pub fn assertion_reach_checks(&self) -> bool {
         !self.no_assertion_reach_checks && !self.visualize
     }
 
+    /// The number of harnesses to verify at a time
+    pub fn jobs(&self) -> usize {
+        match self.jobs {
+            None => 1,
+            Some(0) => std::thread::available_parallelism().map_or(1, |jobs| jobs.get()),
+            Some(jobs) => jobs,
+        }
+    }
+
     pub fn cbmc_object_bits(&self) -> Option<u32> {
         if self.cbmc_args.contains(&OsString::from("--object-bits")) {
             None
@@ -363,6 +496,36 @@ fn check_dry_run_harness_conflicts() {
         assert_eq!(err.kind, ErrorKind::ArgumentConflict);
     }
 
+    #[test]
+    fn check_jobs() {
+        assert_eq!(StandaloneArgs::from_iter(vec!["kani", "file.rs"]).common_opts.jobs(), 1);
+        let a = StandaloneArgs::from_iter(vec!["kani", "file.rs", "--jobs", "4"]);
+        assert_eq!(a.common_opts.jobs(), 4);
+        let a = StandaloneArgs::from_iter(vec!["kani", "file.rs", "-j", "0"]);
+        assert!(a.common_opts.jobs() >= 1);
+
+        // The visualizer and natively run harnesses don't report through CBMC's output
+        let args = vec!["kani", "file.rs", "--jobs", "2", "--visualize"];
+        let err = StandaloneArgs::clap().get_matches_from_safe(args).unwrap_err();
+        assert_eq!(err.kind, ErrorKind::ArgumentConflict);
+    }
+
+    #[test]
+    fn check_harness_memory_limit_conflicts() {
+        // portfolio runs aren't stopped when they exceed the limit
+        let args = vec![
+            "kani",
+            "file.rs",
+            "--enable-unstable",
+            "--solver-portfolio",
+            "--harness-memory-limit",
+            "4096",
+        ];
+        let app = StandaloneArgs::clap();
+        let err = app.get_matches_from_safe(args).unwrap_err();
+        assert_eq!(err.kind, ErrorKind::ArgumentConflict);
+    }
+
     #[test]
     fn check_unwind_conflicts() {
         // --unwind cannot be called without --harness
@@ -408,6 +571,61 @@ fn check_restrict_vtable_unstable() {
         check_unstable_flag("--restrict-vtable")
     }
 
+    #[test]
+    fn check_run_native_unstable() {
+        check_unstable_flag("--run-native")
+    }
+
+    #[test]
+    fn check_profile_functions_unstable() {
+        check_unstable_flag("--profile-functions")
+    }
+
+    #[test]
+    fn check_verification_cache_unstable() {
+        check_unstable_flag("--verification-cache cache")
+    }
+
+    #[test]
+    fn check_fail_fast_unstable() {
+        check_unstable_flag("--fail-fast")
+    }
+
+    #[test]
+    fn check_memory_budget_unstable() {
+        check_unstable_flag("--memory-budget 16384")
+    }
+
+    #[test]
+    fn check_harness_memory_limit_unstable() {
+        check_unstable_flag("--harness-memory-limit 4096")
+    }
+
+    #[test]
+    fn check_perf_history_unstable() {
+        check_unstable_flag("--perf-history history.json")
+    }
+
+    #[test]
+    fn check_slice_harnesses_unstable() {
+        check_unstable_flag("--slice-harnesses")
+    }
+
+    #[test]
+    fn check_solver_portfolio_unstable() {
+        check_unstable_flag("--solver-portfolio")
+    }
+
+    #[test]
+    fn check_write_goto_binary_unstable() {
+        check_unstable_flag("--write-goto-binary")
+    }
+
+    #[test]
+    fn check_trust_layout_unstable() {
+        check_unstable_flag("--trust-layout");
+    }
+
     #[test]
     fn check_restrict_cbmc_args() {
         check_unstable_flag("--cbmc-args --json-ui")
@@ -13,7 +13,7 @@ pub struct CargoOutputs {
     /// The directory where compiler outputs should be directed.
     /// Usually 'target/BUILD_TRIPLE/debug/deps/'
     pub outdir: PathBuf,
-    /// The collection of *.symtab.json files written.
+    /// The collection of *.symtab.json (or *.symtab.out) files written.
     pub symtabs: Vec<PathBuf>,
     /// The location of vtable restrictions files (a directory of *.restrictions.json)
     pub restrictions: Option<PathBuf>,
@@ -64,7 +64,7 @@ pub fn cargo_build(&self) -> Result<CargoOutputs> {
             // mock an answer: mostly the same except we don't/can't expand the globs
             return Ok(CargoOutputs {
                 outdir: outdir.clone(),
-                symtabs: vec![outdir.join("*.symtab.json")],
+                symtabs: vec![outdir.join(format!("*.{}", self.symtab_extension()))],
                 metadata: vec![outdir.join("*.kani-metadata.json")],
                 restrictions: self.args.restrict_vtable().then(|| outdir),
             });
@@ -72,7 +72,7 @@ pub fn cargo_build(&self) -> Result<CargoOutputs> {
 
         Ok(CargoOutputs {
             outdir: outdir.clone(),
-            symtabs: glob(&outdir.join("*.symtab.json"))?,
+            symtabs: glob(&outdir.join(format!("*.{}", self.symtab_extension())))?,
             metadata: glob(&outdir.join("*.kani-metadata.json"))?,
             restrictions: self.args.restrict_vtable().then(|| outdir),
         })
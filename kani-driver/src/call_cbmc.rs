@@ -3,9 +3,12 @@
 
 use anyhow::{bail, Result};
 use kani_metadata::HarnessMetadata;
+use std::collections::BTreeMap;
 use std::ffi::OsString;
+use std::io::Write;
 use std::path::Path;
 use std::process::Command;
+use std::sync::atomic::Ordering;
 use std::time::Instant;
 
 use crate::args::KaniArgs;
@@ -15,6 +18,18 @@
 pub enum VerificationStatus {
     Success,
     Failure,
+    /// Verification was stopped by `--fail-fast` before it completed
+    Stopped,
+}
+
+/// How a run of `run_cbmc_verification` ended
+enum CbmcOutcome {
+    /// CBMC exited by itself, successfully or not, after `elapsed` seconds
+    Completed { succeeded: bool, elapsed: f32 },
+    /// CBMC was killed because another harness failed with `--fail-fast`
+    Stopped,
+    /// CBMC was killed for exceeding `--harness-memory-limit`
+    OutOfMemory,
 }
 
 impl KaniSession {
@@ -23,43 +38,196 @@ pub fn run_cbmc(&self, file: &Path, harness: &HarnessMetadata) -> Result<Verific
         let output_filename = crate::util::append_path(file, "cbmc_output");
 
         {
-            let mut temps = self.temporaries.borrow_mut();
+            let mut temps = self.temporaries.lock().unwrap();
             temps.push(output_filename.clone());
         }
 
         let args: Vec<OsString> = self.cbmc_flags(file, harness)?;
+        let cache_entry = self.verification_cache_entry(file, &args)?;
+        let cached = match &cache_entry {
+            Some(entry) => self.load_verification(entry, &output_filename)?,
+            None => None,
+        };
+        let (cbmc_succeeded, elapsed) = match cached {
+            Some(cbmc_succeeded) => (cbmc_succeeded, None),
+            None => match self.run_cbmc_verification(
+                args,
+                &output_filename,
+                cache_entry.as_deref(),
+                harness,
+            )? {
+                CbmcOutcome::Completed { succeeded, elapsed } => (succeeded, Some(elapsed)),
+                CbmcOutcome::Stopped => return Ok(VerificationStatus::Stopped),
+                CbmcOutcome::OutOfMemory => {
+                    let _report = self.start_report(harness);
+                    if !self.args.quiet {
+                        println!(
+                            "VERIFICATION:- FAILED (CBMC ran out of memory: it exceeded the \
+                            --harness-memory-limit of {} MiB)",
+                            self.args.harness_memory_limit.unwrap_or_default()
+                        );
+                    }
+                    return Ok(VerificationStatus::Failure);
+                }
+            },
+        };
+
+        let profile =
+            if self.args.profile_functions { self.function_profile(file, harness)? } else { None };
+
+        let _report = self.start_report(harness);
+        let status = self.report_cbmc_results(&output_filename, cbmc_succeeded, elapsed)?;
+        if let Some(profile) = profile {
+            print_function_profile(harness, &profile);
+        }
 
-        // TODO get cbmc path from self
-        let mut cmd = Command::new("cbmc");
-        cmd.args(args);
+        Ok(status)
+    }
 
-        if self.args.output_format == crate::args::OutputFormat::Old {
-            if self.run_terminal(cmd).is_err() {
-                return Ok(VerificationStatus::Failure);
-            }
-        } else {
+    /// Whether CBMC prints its results straight to the terminal, which it does in the old output
+    /// format, unless harnesses are verified concurrently or the results may come from the cache.
+    /// Otherwise, its output goes to a file for `report_cbmc_results`.
+    fn cbmc_prints_results(&self) -> bool {
+        self.args.output_format == crate::args::OutputFormat::Old
+            && self.args.jobs() == 1
+            && self.args.verification_cache.is_none()
+            && !self.args.solver_portfolio
+            && self.args.perf_history.is_none()
+            && self.args.harness_memory_limit.is_none()
+    }
+
+    /// Run CBMC with `args` to verify the harness, or the portfolio of CBMC configurations with
+    /// `--solver-portfolio`. A run that completed is stored in the verification cache, if there's
+    /// one, and in the performance history, with `--perf-history`.
+    fn run_cbmc_verification(
+        &self,
+        mut args: Vec<OsString>,
+        output_filename: &Path,
+        cache_entry: Option<&Path>,
+        harness: &HarnessMetadata,
+    ) -> Result<CbmcOutcome> {
+        if self.args.output_format != crate::args::OutputFormat::Old {
             // extra argument
-            cmd.arg("--json-ui");
-
-            let now = Instant::now();
-            let _cbmc_result = self.run_redirect(cmd, &output_filename)?;
-            let elapsed = now.elapsed().as_secs_f32();
-            let format_result = self.format_cbmc_output(&output_filename);
-
-            if format_result.is_err() {
-                // Because of things like --assertion-reach-checks and other future features,
-                // we now decide if we fail or not based solely on the output of the formatter.
-                return Ok(VerificationStatus::Failure);
-                // todo: this is imperfect, since we don't know why failure happened.
-                // the best possible fix is port to rust instead of using python, or getting more
-                // feedback than just exit status (or using a particular magic exit code?)
+            args.push("--json-ui".into());
+        }
+
+        let now = Instant::now();
+        let run = if self.args.solver_portfolio {
+            self.run_solver_portfolio(&args, output_filename, harness)?
+        } else {
+            // TODO get cbmc path from self
+            let mut cmd = Command::new("cbmc");
+            cmd.args(args);
+            if self.cbmc_prints_results() {
+                let succeeded = self.run_terminal(cmd).is_ok();
+                return Ok(CbmcOutcome::Completed {
+                    succeeded,
+                    elapsed: now.elapsed().as_secs_f32(),
+                });
+            }
+            self.run_streamed(cmd, output_filename, harness)?
+        };
+        let elapsed = now.elapsed().as_secs_f32();
+        if let Some(peak_rss_kb) = run.peak_rss_kb {
+            self.peak_rss_kb.fetch_max(peak_rss_kb, Ordering::Relaxed);
+        }
+        if run.out_of_memory {
+            return Ok(CbmcOutcome::OutOfMemory);
+        }
+        if run.status.code().is_none() && self.verification_stopped() {
+            return Ok(CbmcOutcome::Stopped);
+        }
+        // CBMC exits with 0 if all properties hold and with 10 if some fail. Anything else, e.g.
+        // running out of memory, says nothing about the harness.
+        if let Some(0 | 10) = run.status.code() {
+            if let Some(entry) = cache_entry {
+                self.store_verification(entry, output_filename, run.status.success())?;
+            }
+            self.record_perf(harness, output_filename, &run, elapsed)?;
+        }
+        Ok(CbmcOutcome::Completed { succeeded: run.status.success(), elapsed })
+    }
+
+    /// Print the results of a run of `run_cbmc_verification`, which took `elapsed` seconds or
+    /// was reused from the verification cache
+    fn report_cbmc_results(
+        &self,
+        output_filename: &Path,
+        cbmc_succeeded: bool,
+        elapsed: Option<f32>,
+    ) -> Result<VerificationStatus> {
+        if self.args.output_format == crate::args::OutputFormat::Old {
+            if !self.cbmc_prints_results() && !self.args.quiet && !self.args.dry_run {
+                std::io::stdout().write_all(&std::fs::read(output_filename)?)?;
             }
-            println!("Verification Time: {}s", elapsed);
+            return Ok(if cbmc_succeeded {
+                VerificationStatus::Success
+            } else {
+                VerificationStatus::Failure
+            });
+        }
+
+        let format_result = self.format_cbmc_output(output_filename);
+        if format_result.is_err() {
+            // Because of things like --assertion-reach-checks and other future features,
+            // we now decide if we fail or not based solely on the output of the formatter.
+            return Ok(VerificationStatus::Failure);
+            // todo: this is imperfect, since we don't know why failure happened.
+            // the best possible fix is port to rust instead of using python, or getting more
+            // feedback than just exit status (or using a particular magic exit code?)
+        }
+        match elapsed {
+            Some(elapsed) => println!("Verification Time: {}s", elapsed),
+            None => println!("Verification results reused from the verification cache"),
         }
 
         Ok(VerificationStatus::Success)
     }
 
+    /// Attribute the cost of symbolic execution of a harness to the functions it runs, most
+    /// expensive first (or `None` in a dry run). This runs CBMC again with `--program-only`, which
+    /// prints each SSA step with the function it comes from, and `--symex-coverage-report`, which
+    /// counts how many times symbolic execution went through each line.
+    fn function_profile(
+        &self,
+        file: &Path,
+        harness: &HarnessMetadata,
+    ) -> Result<Option<Vec<(String, FunctionCost)>>> {
+        let program_filename = crate::util::append_path(file, "program_only");
+        let coverage_filename = crate::util::append_path(file, "symex_coverage.xml");
+        {
+            let mut temps = self.temporaries.lock().unwrap();
+            temps.push(program_filename.clone());
+            temps.push(coverage_filename.clone());
+        }
+
+        let mut args = self.cbmc_flags(file, harness)?;
+        args.push("--program-only".into());
+        args.push("--symex-coverage-report".into());
+        args.push(coverage_filename.clone().into_os_string());
+
+        // TODO get cbmc path from self
+        let mut cmd = Command::new("cbmc");
+        cmd.args(args);
+        self.run_redirect(cmd, &program_filename)?;
+        if self.args.dry_run {
+            return Ok(None);
+        }
+
+        let mut profile = BTreeMap::new();
+        add_ssa_steps(&std::fs::read_to_string(&program_filename)?, &mut profile);
+        // CBMC does not write the coverage report if symbolic execution ended early.
+        if let Ok(coverage) = std::fs::read_to_string(&coverage_filename) {
+            add_symex_steps(&coverage, &mut profile);
+        }
+
+        let mut costs: Vec<_> = profile.into_iter().collect();
+        costs.sort_by(|(_, a), (_, b)| {
+            (b.ssa_steps, b.symex_steps).cmp(&(a.ssa_steps, a.symex_steps))
+        });
+        Ok(Some(costs))
+    }
+
     /// used by call_cbmc_viewer, invokes different variants of CBMC.
     // TODO: this could use some cleanup and refactoring.
     pub fn call_cbmc(&self, args: Vec<OsString>, output: &Path) -> Result<()> {
@@ -102,6 +270,11 @@ pub fn cbmc_flags(
 
         args.push("--slice-formula".into());
 
+        if self.args.fail_fast {
+            // CBMC only prints the results once it has decided all the properties.
+            args.push("--stop-on-fail".into());
+        }
+
         args.extend(self.args.cbmc_args.iter().cloned());
 
         args.push(file.to_owned().into_os_string());
@@ -151,6 +324,64 @@ pub fn cbmc_check_flags(&self) -> Vec<OsString> {
     }
 }
 
+/// How many functions `--profile-functions` reports for each harness
+const PROFILE_FUNCTIONS_SHOWN: usize = 20;
+
+/// Print the most expensive functions of a profile from `function_profile`
+fn print_function_profile(harness: &HarnessMetadata, costs: &[(String, FunctionCost)]) {
+    println!("Function profile for {}:", harness.pretty_name);
+    println!("{:>12} {:>12}  function", "SSA steps", "symex steps");
+    for (function, cost) in costs.iter().take(PROFILE_FUNCTIONS_SHOWN) {
+        println!("{:>12} {:>12}  {}", cost.ssa_steps, cost.symex_steps, function);
+    }
+}
+
+/// The cost of symbolic execution attributed to one function
+#[derive(Debug, Default, PartialEq, Eq)]
+pub struct FunctionCost {
+    /// SSA steps the function contributed to the formula, i.e., the constraints it generated
+    pub ssa_steps: u64,
+    /// Times symbolic execution executed the lines of the function
+    pub symex_steps: u64,
+}
+
+/// Count the SSA steps per function in the output of `cbmc --program-only`. Each step is preceded
+/// by a comment with its source location, e.g., `// 42 file vec.c line 12 function vec_push`.
+fn add_ssa_steps(program: &str, profile: &mut BTreeMap<String, FunctionCost>) {
+    for line in program.lines().filter(|line| line.starts_with("// ")) {
+        if let Some((_, location)) = line.split_once(" function ") {
+            if let Some(function) = location.split_whitespace().next() {
+                profile.entry(function.to_string()).or_default().ssa_steps += 1;
+            }
+        }
+    }
+}
+
+/// Add up the line hits per method of the Cobertura report written by `--symex-coverage-report`.
+fn add_symex_steps(coverage: &str, profile: &mut BTreeMap<String, FunctionCost>) {
+    // Lines are listed both inside each method and for the whole class, so we only count the ones
+    // inside a method.
+    let mut method: Option<String> = None;
+    for tag in coverage.split('<').skip(1) {
+        if tag.starts_with("method ") {
+            method = xml_attribute(tag, "name").map(str::to_string);
+        } else if tag.starts_with("/method") {
+            method = None;
+        } else if tag.starts_with("line ") {
+            let hits = xml_attribute(tag, "hits").and_then(|hits| hits.parse::<u64>().ok());
+            if let (Some(method), Some(hits)) = (&method, hits) {
+                profile.entry(method.clone()).or_default().symex_steps += hits;
+            }
+        }
+    }
+}
+
+fn xml_attribute<'a>(tag: &'a str, name: &str) -> Option<&'a str> {
+    let start = tag.find(&format!(" {}=\"", name))? + name.len() + 3;
+    let len = tag[start..].find('"')?;
+    Some(&tag[start..start + len])
+}
+
 /// Solve Unwind Value from conflicting inputs of unwind values. (--default-unwind, annotation-unwind, --unwind)
 pub fn resolve_unwind_value(args: &KaniArgs, harness_metadata: &HarnessMetadata) -> Option<u32> {
     // Check for which flag is being passed and prioritize extracting unwind from the
@@ -166,6 +397,26 @@ mod tests {
 
     use super::*;
 
+    #[test]
+    fn check_function_profile() {
+        let program = "// 12 file vec.c line 3 function vec_push\n(1) x#1 == 0\n\
+                       // 13 file vec.c line 4 function vec_push\n(2) x#2 == 1\n\
+                       // 14 file lib.rs line 9 column 5 function main\n(3) y#1 == 1\n\
+                       // 15\n(4) z#1 == 2\n";
+        let coverage = r#"<class name="vec.c"><methods>
+            <method name="vec_push" signature=""><lines>
+            <line number="3" hits="4" branch="false"/><line number="4" hits="2" branch="false"/>
+            </lines></method></methods><lines><line number="3" hits="4" branch="false"/></lines>
+            </class>"#;
+        let mut profile = BTreeMap::new();
+        add_ssa_steps(program, &mut profile);
+        add_symex_steps(coverage, &mut profile);
+
+        assert_eq!(profile.len(), 2);
+        assert_eq!(profile["vec_push"], FunctionCost { ssa_steps: 2, symex_steps: 6 });
+        assert_eq!(profile["main"], FunctionCost { ssa_steps: 1, symex_steps: 0 });
+    }
+
     #[test]
     fn check_resolve_unwind_value() {
         // Command line unwind value for specific harnesses take precedence over default annotation value
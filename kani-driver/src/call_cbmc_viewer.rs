@@ -24,7 +24,7 @@ pub fn run_visualize(
         let property_filename = alter_extension(file, "property.xml");
 
         {
-            let mut temps = self.temporaries.borrow_mut();
+            let mut temps = self.temporaries.lock().unwrap();
             temps.push(results_filename.clone());
             temps.push(coverage_filename.clone());
             temps.push(property_filename.clone());
@@ -1,34 +1,83 @@
 // Copyright Kani Contributors
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
-use anyhow::Result;
+use anyhow::{bail, Context, Result};
 use std::ffi::OsString;
+use std::os::unix::ffi::OsStrExt;
 use std::path::{Path, PathBuf};
 use std::process::Command;
 
 use crate::args::AbstractionType;
 use crate::session::KaniSession;
+use crate::util::{unique_tmp_path, ContentHash};
+use kani_metadata::HarnessMetadata;
+
+/// The bound on the initial capacity of the "c-ffi" vectors of a harness without a
+/// `#[kani::vec_capacity]` attribute, in symbolic-capacity mode
+const DEFAULT_VEC_CAPACITY_BOUND: u32 = 8;
+
+/// The functions of vec.c that the "c-ffi" Vec (c_vec.rs) calls into
+const VEC_C_FUNCTIONS: &[&str] = &[
+    "vec_new",
+    "vec_with_capacity",
+    "vec_push",
+    "vec_pop",
+    "vec_cap",
+    "vec_len",
+    "vec_append",
+    "vec_extend_from_slice",
+    "vec_reserve",
+    "vec_sized_grow",
+    "vec_free",
+    "vec_bytes_new",
+    "vec_bytes_with_capacity",
+    "vec_push_bytes",
+    "vec_pop_bytes",
+    "vec_bytes_cap",
+    "vec_bytes_len",
+    "vec_append_bytes",
+    "vec_bytes_sized_grow",
+    "vec_bytes_reserve",
+    "vec_bytes_free",
+];
+
+/// The functions of hashset.c that the "c-ffi" HashSets (c_hashset.rs) call into
+const HASHSET_C_FUNCTIONS: &[&str] = &[
+    "hashset_new",
+    "hashset_insert",
+    "hashset_contains",
+    "hashset_remove",
+    "hashset_u32_new",
+    "hashset_u32_insert",
+    "hashset_u32_contains",
+    "hashset_u32_remove",
+    "hashset_bytes_new",
+    "hashset_bytes_insert",
+    "hashset_bytes_contains",
+    "hashset_bytes_remove",
+    "hashset_bytes_len",
+    "hashset_bytes_free",
+];
+
+/// The allocator functions that kani_lib.c defines
+const KANI_LIB_C_FUNCTIONS: &[&str] =
+    &["__rust_alloc", "__rust_alloc_zeroed", "__rust_dealloc", "__rust_realloc"];
 
 impl KaniSession {
     /// Given a set of goto binaries (`inputs`), produce `output` by linking everything
     /// together (including essential libraries). The result is generic over all proof harnesses.
-    pub fn link_goto_binary(&self, inputs: &[PathBuf], output: &Path) -> Result<()> {
+    ///
+    /// Only the C libraries that define some of the `undefined_functions` of the inputs are
+    /// linked in, so that later passes don't have to drop everything the crates don't use.
+    pub fn link_goto_binary(
+        &self,
+        inputs: &[PathBuf],
+        output: &Path,
+        undefined_functions: &[String],
+    ) -> Result<()> {
         let mut args: Vec<OsString> = Vec::new();
         args.extend(inputs.iter().map(|x| x.clone().into_os_string()));
-        args.extend(self.args.c_lib.iter().map(|x| x.clone().into_os_string()));
-
-        // Special case hack for handling the "c-ffi" abs-type
-        if self.args.use_abs && self.args.abs_type == AbstractionType::CFfi {
-            let vec = self.kani_c_stubs.join("vec/vec.c");
-            let hashset = self.kani_c_stubs.join("hashset/hashset.c");
-
-            args.push(vec.into_os_string());
-            args.push(hashset.into_os_string());
-        }
-
-        // TODO think about this: kani_lib_c is just an empty c file. Maybe we could just
-        // create such an empty file ourselves instead of having to look up this path.
-        args.push(self.kani_lib_c.clone().into_os_string());
+        args.extend(self.c_lib_args(undefined_functions)?);
 
         args.push("-o".into());
         args.push(output.to_owned().into_os_string());
@@ -42,18 +91,290 @@ pub fn link_goto_binary(&self, inputs: &[PathBuf], output: &Path) -> Result<()>
         Ok(())
     }
 
+    /// The arguments of goto-cc for the C libraries to link with goto binaries that call the
+    /// `undefined_functions`: the ones from `--c-lib`, and the Kani C libraries that define some
+    /// of the `undefined_functions`.
+    fn c_lib_args(&self, undefined_functions: &[String]) -> Result<Vec<OsString>> {
+        let mut args: Vec<OsString> = Vec::new();
+        args.extend(self.args.c_lib.iter().map(|x| x.clone().into_os_string()));
+
+        let mut defines: Vec<OsString> = Vec::new();
+        let mut libs: Vec<PathBuf> = Vec::new();
+
+        // Special case hack for handling the "c-ffi" abs-type
+        if self.args.use_abs && self.args.abs_type == AbstractionType::CFfi {
+            // Select the growth strategy of vec.c (see vec_grow_exact).
+            if self.args.c_ffi_symbolic_capacity {
+                defines.push("-DKANI_VEC_SYMBOLIC_CAPACITY".into());
+            } else if !self.args.c_ffi_vec_realloc {
+                defines.push("-DKANI_VEC_END_POINTER".into());
+            }
+            if self.args.c_ffi_unbounded_arrays {
+                defines.push("-DKANI_UNBOUNDED_ARRAYS".into());
+            }
+            if self.uses_c_lib(undefined_functions, VEC_C_FUNCTIONS) {
+                libs.push(self.kani_c_stubs.join("vec/vec.c"));
+            }
+            if self.uses_c_lib(undefined_functions, HASHSET_C_FUNCTIONS) {
+                libs.push(self.kani_c_stubs.join("hashset/hashset.c"));
+            }
+        }
+
+        // `Layout` guarantees the alignment preconditions checked by kani_lib.c, unless unsafe
+        // code broke its contract, so only drop those checks when asked to.
+        if self.args.trust_layout {
+            defines.push("-DKANI_TRUST_LAYOUT".into());
+        }
+
+        if self.uses_c_lib(undefined_functions, KANI_LIB_C_FUNCTIONS) {
+            libs.push(self.kani_lib_c.clone());
+        }
+
+        args.extend(self.compile_kani_c_libs(&libs, &defines)?);
+        Ok(args)
+    }
+
+    /// Whether the crates call any of the `functions` that a C library defines. A dry-run has no
+    /// metadata, so it shows every library.
+    fn uses_c_lib(&self, undefined_functions: &[String], functions: &[&str]) -> bool {
+        self.args.dry_run
+            || undefined_functions.iter().any(|function| functions.contains(&function.as_str()))
+    }
+
+    /// Produce goto objects for the C libraries that Kani links with every crate, and return the
+    /// arguments that `link_goto_binary` should pass for them.
+    ///
+    /// These libraries are identical across crates, so the objects are cached (see
+    /// `c_lib_cache_dir`) and keyed by the CBMC version, the defines and the contents of each
+    /// library. This way we only pay for the C front-end the first time a configuration is used.
+    fn compile_kani_c_libs(&self, libs: &[PathBuf], defines: &[OsString]) -> Result<Vec<OsString>> {
+        let cache_dir = match self.c_lib_cache_dir()? {
+            Some(cache_dir) => cache_dir,
+            None => {
+                // Without a cache (and in a dry-run, where nothing gets cached), goto-cc compiles
+                // the libraries as part of the link.
+                let mut args = defines.to_vec();
+                args.extend(libs.iter().map(|x| x.clone().into_os_string()));
+                return Ok(args);
+            }
+        };
+
+        let mut objects = Vec::new();
+        for lib in libs {
+            let mut hash = ContentHash::new();
+            hash.update(&std::fs::read(lib)?);
+            defines.iter().for_each(|define| hash.update(define.as_bytes()));
+            let stem = lib.file_stem().unwrap().to_string_lossy();
+            let object = cache_dir.join(format!("{}-{}.goto", stem, hash.finish()));
+
+            if !object.exists() {
+                // Compile to a file of our own and rename it into place, so that concurrent Kani
+                // runs, and harnesses linked concurrently with `--slice-harnesses`, never observe a
+                // partially written object. Whichever finishes last replaces an identical object.
+                let tmp = unique_tmp_path(&object);
+                let mut cmd = Command::new("goto-cc");
+                cmd.arg("-c").args(defines).arg(lib).arg("-o").arg(&tmp);
+                if let Err(error) = self.run_suppress(cmd) {
+                    let _ = std::fs::remove_file(&tmp);
+                    return Err(error);
+                }
+                std::fs::rename(&tmp, &object)?;
+            }
+
+            objects.push(object.into_os_string());
+        }
+
+        Ok(objects)
+    }
+
+    /// The directory to cache the goto objects of the C libraries in, for the CBMC in use: under
+    /// the Kani installation, or under the cache directory of the user if the installation is
+    /// read-only, e.g. a shared release bundle. `None` if neither can be written.
+    fn c_lib_cache_dir(&self) -> Result<Option<PathBuf>> {
+        if self.args.dry_run {
+            return Ok(None);
+        }
+        let version = self.cbmc_version()?;
+        let user_cache = std::env::var_os("XDG_CACHE_HOME")
+            .map(PathBuf::from)
+            .or_else(|| std::env::var_os("HOME").map(|home| Path::new(&home).join(".cache")))
+            .map(|cache| cache.join("kani/goto"));
+        let candidates = std::iter::once(self.kani_c_lib_cache.clone()).chain(user_cache);
+        Ok(candidates.map(|dir| dir.join(&version)).find(|dir| is_writable_dir(dir)))
+    }
+
+    /// The version of CBMC we are using, which also determines the goto binary format. CBMC is
+    /// only asked once per session.
+    pub fn cbmc_version(&self) -> Result<String> {
+        let mut version = self.cbmc_version.lock().unwrap();
+        if version.is_none() {
+            // TODO get cbmc path from self
+            let output =
+                Command::new("cbmc").arg("--version").output().context("Failed to invoke cbmc")?;
+            let stdout = String::from_utf8_lossy(&output.stdout);
+            match stdout.split_whitespace().next() {
+                Some(found) if output.status.success() => *version = Some(found.to_string()),
+                _ => bail!("Unable to determine the version of cbmc"),
+            }
+        }
+        Ok(version.clone().unwrap())
+    }
+
     /// Produce a goto binary with its entry point set to a particular proof harness.
     pub fn specialize_to_proof_harness(
         &self,
         input: &Path,
         output: &Path,
-        function: &str,
+        harness: &HarnessMetadata,
+    ) -> Result<()> {
+        self.link_proof_harness(vec![input.to_owned().into_os_string()], output, harness)
+    }
+
+    /// Produce the goto binary of a proof harness that kani-compiler sliced with
+    /// `--slice-harnesses`: link its slice with the goto binaries `goto_objs` of the other crates,
+    /// and the C libraries it calls into, with its entry point set to the harness. This replaces
+    /// both `link_goto_binary` and `specialize_to_proof_harness`, so the binary of a harness only
+    /// has what it can reach, and the C libraries it needs, from the start.
+    ///
+    /// When there are other crates, the harness may reach their functions, and through them, any
+    /// C library they call into, so all of those in `undefined_functions` are linked.
+    pub fn link_harness_slice(
+        &self,
+        goto_objs: &[PathBuf],
+        undefined_functions: &[String],
+        harness: &HarnessMetadata,
+        output: &Path,
     ) -> Result<()> {
+        let slice = PathBuf::from(harness.goto_file.as_ref().unwrap());
+        let mut args = vec![slice.clone().into_os_string()];
+        // The whole binary of the crate of the harness is replaced by the slice.
+        let others = goto_objs.iter().filter(|obj| !is_crate_object(&slice, obj));
+        args.extend(others.map(|obj| obj.clone().into_os_string()));
+        let undefined_functions =
+            if args.len() == 1 { &harness.undefined_functions } else { undefined_functions };
+        args.extend(self.c_lib_args(undefined_functions)?);
+        self.link_proof_harness(args, output, harness)
+    }
+
+    /// Link `inputs` into a goto binary with its entry point set to `harness`.
+    fn link_proof_harness(
+        &self,
+        mut inputs: Vec<OsString>,
+        output: &Path,
+        harness: &HarnessMetadata,
+    ) -> Result<()> {
+        if self.args.use_abs
+            && self.args.abs_type == AbstractionType::CFfi
+            && self.args.c_ffi_symbolic_capacity
+        {
+            inputs.push(self.write_vec_capacity_bound(output, harness)?.into_os_string());
+        }
         let mut cmd = Command::new("goto-cc");
-        cmd.arg(input).args(["--function", function, "-o"]).arg(output);
+        cmd.args(inputs);
+        cmd.args(["--function", &harness.mangled_name, "-o"]).arg(output);
 
         self.run_suppress(cmd)?;
 
         Ok(())
     }
+
+    /// Write the C file that defines the bound on the initial capacity of the vectors of a harness
+    /// in symbolic-capacity mode (see vec_initial_capacity in vec.c).
+    fn write_vec_capacity_bound(
+        &self,
+        output: &Path,
+        harness: &HarnessMetadata,
+    ) -> Result<PathBuf> {
+        let bound_file = crate::util::append_path(output, "vec_capacity.c");
+        {
+            let mut temps = self.temporaries.lock().unwrap();
+            temps.push(bound_file.clone());
+        }
+        if !self.args.dry_run {
+            let capacity = harness.vec_capacity.unwrap_or(DEFAULT_VEC_CAPACITY_BOUND);
+            std::fs::write(
+                &bound_file,
+                format!("#include <stddef.h>\nsize_t __KANI_vec_max_capacity = {};\n", capacity),
+            )?;
+        }
+        Ok(bound_file)
+    }
+}
+
+/// Whether `object` is the goto binary of the crate that kani-compiler wrote `slice` for: slices are
+/// named `<crate>.symtab.harness<n>.out`, and the binary of the crate is `<crate>.symtab.out`.
+fn is_crate_object(slice: &Path, object: &Path) -> bool {
+    slice.with_extension("").with_extension("") == object.with_extension("")
+}
+
+/// Whether `dir` exists, or can be created, and we can write files to it
+fn is_writable_dir(dir: &Path) -> bool {
+    if std::fs::create_dir_all(dir).is_err() {
+        return false;
+    }
+    let probe = unique_tmp_path(&dir.join(".probe"));
+    let writable = std::fs::File::create(&probe).is_ok();
+    let _ = std::fs::remove_file(&probe);
+    writable
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// The names followed by `(` in `code` that start with `prefix`, e.g. the functions it declares
+    fn functions_named(code: &str, prefix: &str) -> Vec<String> {
+        let is_identifier = |c: char| c.is_ascii_alphanumeric() || c == '_';
+        let mut names: Vec<String> = code
+            .match_indices(prefix)
+            .filter(|(start, _)| !code[..*start].ends_with(is_identifier))
+            .filter_map(|(start, _)| {
+                let name = code[start..].split(|c| !is_identifier(c)).next()?;
+                code[start + name.len()..].starts_with('(').then(|| name.to_string())
+            })
+            .collect();
+        names.sort();
+        names.dedup();
+        names
+    }
+
+    fn sorted(functions: &[&str]) -> Vec<String> {
+        let mut functions: Vec<String> = functions.iter().map(|f| f.to_string()).collect();
+        functions.sort();
+        functions
+    }
+
+    #[test]
+    fn check_c_lib_functions() {
+        let library = Path::new(env!("CARGO_MANIFEST_DIR")).join("../library/kani");
+        let read = |path: &str| std::fs::read_to_string(library.join(path)).unwrap();
+        // The declarations of the Rust stubs, without their `fn`
+        let declarations = |path: &str| -> String {
+            let code = read(path);
+            let lines = code.lines().filter_map(|line| line.trim().strip_prefix("fn "));
+            lines.collect::<Vec<_>>().join("\n")
+        };
+
+        // The Rust stubs call exactly the listed functions...
+        let rust_vec = functions_named(&declarations("stubs/Rust/vec/c_vec.rs"), "vec_");
+        assert_eq!(rust_vec, sorted(VEC_C_FUNCTIONS));
+        let rust_hashset =
+            functions_named(&declarations("stubs/Rust/hashset/c_hashset.rs"), "hashset_");
+        assert_eq!(rust_hashset, sorted(HASHSET_C_FUNCTIONS));
+
+        // ...and the C libraries define them.
+        let vec_c = functions_named(&read("stubs/C/vec/vec.c"), "vec_");
+        assert!(VEC_C_FUNCTIONS.iter().all(|f| vec_c.contains(&f.to_string())));
+        let hashset_c = functions_named(&read("stubs/C/hashset/hashset.c"), "hashset_");
+        assert!(HASHSET_C_FUNCTIONS.iter().all(|f| hashset_c.contains(&f.to_string())));
+        assert_eq!(functions_named(&read("kani_lib.c"), "__rust_"), sorted(KANI_LIB_C_FUNCTIONS));
+    }
+
+    #[test]
+    fn check_is_crate_object() {
+        let slice = Path::new("deps/foo-1a2b.symtab.harness3.out");
+        assert!(is_crate_object(slice, Path::new("deps/foo-1a2b.symtab.out")));
+        assert!(!is_crate_object(slice, Path::new("deps/bar-3c4d.symtab.out")));
+        assert!(!is_crate_object(slice, Path::new("foo-1a2b.symtab.out")));
+    }
 }
@@ -1,10 +1,14 @@
 // Copyright Kani Contributors
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
-use anyhow::Result;
+use anyhow::{bail, Result};
+use kani_metadata::HarnessMetadata;
+use serde::de::{Deserializer, IgnoredAny, MapAccess, Visitor};
+use serde::Deserialize;
+use std::collections::HashMap;
 use std::ffi::OsString;
 use std::fs::File;
-use std::io::BufReader;
+use std::io::{BufRead, BufReader, BufWriter, Write};
 use std::path::Path;
 use std::process::Command;
 
@@ -19,26 +23,24 @@ pub fn run_goto_instrument(
         input: &Path,
         output: &Path,
         symtabs: &[impl AsRef<Path>],
-        function: &str,
+        harness: &HarnessMetadata,
     ) -> Result<()> {
-        // We actually start by calling goto-cc to start the specialization:
-        self.specialize_to_proof_harness(input, output, function)?;
-
-        // Run sanity checks in the model generated by kani-compiler before any goto-instrument
-        // transformation.
-        if self.args.run_sanity_checks {
-            self.goto_sanity_check(output)?;
+        // We actually start by calling goto-cc to start the specialization, unless kani-compiler
+        // sliced the harness, and `link_harness_slice` already produced `output`.
+        if harness.goto_file.is_none() {
+            if self.args.slice_harnesses && !self.args.dry_run {
+                // `input` is never linked with `--slice-harnesses`. (A dry run mocks the metadata.)
+                bail!("kani-compiler did not write a goto binary for {}", harness.pretty_name);
+            }
+            self.specialize_to_proof_harness(input, output, harness)?;
         }
 
-        if self.args.checks.undefined_function_on() {
-            self.add_library(output)?;
-            self.undefined_functions(output)?;
-        } else {
-            self.just_drop_unused_functions(output)?;
+        for mut args in self.harness_instrument_passes() {
+            args.push(output.to_owned().into_os_string()); // input
+            args.push(output.to_owned().into_os_string()); // output
+            self.call_goto_instrument(args)?;
         }
 
-        self.rewrite_back_edges(output)?;
-
         if self.args.gen_c {
             let c_outfile = alter_extension(output, "c");
             // We don't put the C file into temporaries to be deleted.
@@ -65,7 +67,7 @@ pub fn apply_vtable_restrictions(&self, file: &Path, source: &Path) -> Result<()
         let linked_restrictions = alter_extension(file, "linked-restrictions.json");
 
         {
-            let mut temps = self.temporaries.borrow_mut();
+            let mut temps = self.temporaries.lock().unwrap();
             temps.push(linked_restrictions.clone());
         }
 
@@ -81,69 +83,38 @@ pub fn apply_vtable_restrictions(&self, file: &Path, source: &Path) -> Result<()
         self.call_goto_instrument(args)
     }
 
-    /// Link the binary against the CBMC model for C library functions.
-    /// Normally this happens implicitly, but we use this explicitly
-    /// before we invoke `undefined_functions` below, otherwise these
-    /// functions appear undefined.
-    fn add_library(&self, file: &Path) -> Result<()> {
-        let args: Vec<OsString> = vec![
-            "--add-library".into(),
-            file.to_owned().into_os_string(), // input
-            file.to_owned().into_os_string(), // output
-        ];
-
-        self.call_goto_instrument(args)
-    }
-
-    /// Instruct CBMC to "assert false" when invoking an undefined function.
-    /// (This contrasts with its default behavior of returning `nondet`, which is
-    /// unsound in the face of side-effects.)
-    /// Then remove unused functions. (Oddly, it seems CBMC will both see some
-    /// functions as unused and remove them, and also as used and so would
-    /// generate "assert false". So it's essential to do this afterwards.)
-    fn undefined_functions(&self, file: &Path) -> Result<()> {
-        let args: Vec<OsString> = vec![
-            "--generate-function-body-options".into(),
-            "assert-false-assume-false".into(),
-            "--generate-function-body".into(),
-            ".*".into(),
-            "--drop-unused-functions".into(),
-            file.to_owned().into_os_string(), // input
-            file.to_owned().into_os_string(), // output
-        ];
-
-        self.call_goto_instrument(args)
-    }
-
-    /// Remove all functions unreachable from the current proof harness.
-    fn just_drop_unused_functions(&self, file: &Path) -> Result<()> {
-        let args: Vec<OsString> = vec![
-            "--drop-unused-functions".into(),
-            file.to_owned().into_os_string(), // input
-            file.to_owned().into_os_string(), // output
-        ];
-
-        self.call_goto_instrument(args)
-    }
-
-    fn rewrite_back_edges(&self, file: &Path) -> Result<()> {
-        let args: Vec<OsString> = vec![
-            "--ensure-one-backedge-per-target".into(),
-            file.to_owned().into_os_string(), // input
-            file.to_owned().into_os_string(), // output
-        ];
+    /// The goto-instrument flags for the transformations of a specialized proof harness, one
+    /// invocation of goto-instrument each.
+    ///
+    /// goto-instrument applies the transformations of an invocation in an order of its own,
+    /// regardless of the order of the flags, so only those that can run in its order share an
+    /// invocation: it validates the model right after reading it, then generates the bodies of
+    /// undefined functions, drops unused functions and rewrites back edges. The C library has to be
+    /// added by an invocation of its own, before bodies are generated, or its functions would get
+    /// "assert false" bodies (see `add_library_flags`).
+    fn harness_instrument_passes(&self) -> Vec<Vec<OsString>> {
+        let mut passes = Vec::new();
+        let mut args = Vec::new();
 
-        self.call_goto_instrument(args)
-    }
+        // Run sanity checks in the model generated by kani-compiler before any goto-instrument
+        // transformation.
+        if self.args.run_sanity_checks {
+            args.extend(goto_sanity_check_flags());
+        }
 
-    fn goto_sanity_check(&self, file: &Path) -> Result<()> {
-        let args: Vec<OsString> = vec![
-            "--validate-goto-model".into(),
-            file.to_owned().into_os_string(), // input
-            file.to_owned().into_os_string(), // output
-        ];
+        // Native runs get their C library from the C compiler, so we neither add CBMC's models
+        // of it nor generate bodies for undefined functions (those would be dumped as C too).
+        if self.args.checks.undefined_function_on() && !self.args.run_native {
+            args.extend(add_library_flags());
+            passes.push(std::mem::take(&mut args));
+            args.extend(undefined_functions_flags());
+        } else {
+            args.extend(just_drop_unused_functions_flags());
+        }
 
-        self.call_goto_instrument(args)
+        args.extend(rewrite_back_edges_flags());
+        passes.push(args);
+        passes
     }
 
     /// Generate a .c file from a goto binary (i.e. --gen-c)
@@ -167,24 +138,20 @@ pub fn demangle_c(
         c_file: &Path,
         demangled_file: &Path,
     ) -> Result<()> {
-        let mut c_code = std::fs::read_to_string(c_file)?;
+        let mut pretty_names = HashMap::new();
         for symtab_file in symtab_files {
             let reader = BufReader::new(File::open(symtab_file.as_ref())?);
-            let symtab: serde_json::Value = serde_json::from_reader(reader)?;
-            for (_, symbol) in symtab["symbolTable"].as_object().unwrap() {
-                if let Some(serde_json::Value::String(name)) = symbol.get("name") {
-                    if let Some(serde_json::Value::String(pretty)) = symbol.get("prettyName") {
-                        // Struct names start with "tag-", but this prefix is not used in the GotoC files, so we strip it.
-                        // If there is no such prefix, we leave the name unchanged.
-                        let name = name.strip_prefix("tag-").unwrap_or(name);
-                        if !pretty.is_empty() && pretty != name {
-                            c_code = c_code.replace(name, pretty);
-                        }
-                    }
-                }
+            let symtab: PrettyNames = serde_json::from_reader(reader)?;
+            for (name, pretty) in symtab.pretty_names {
+                // Should several symbol tables rename a symbol, the first one wins.
+                pretty_names.entry(name).or_insert(pretty);
             }
         }
-        std::fs::write(demangled_file, c_code)?;
+
+        let reader = BufReader::new(File::open(c_file)?);
+        let mut writer = BufWriter::new(File::create(demangled_file)?);
+        demangle_identifiers(reader, &mut writer, &pretty_names)?;
+        writer.flush()?;
         Ok(())
     }
 
@@ -197,3 +164,139 @@ fn call_goto_instrument(&self, args: Vec<OsString>) -> Result<()> {
         self.run_suppress(cmd)
     }
 }
+
+/// The `prettyName` of each symbol of a symbol table that has one different from its name
+#[derive(Deserialize)]
+struct PrettyNames {
+    #[serde(rename = "symbolTable", deserialize_with = "collect_pretty_names")]
+    pretty_names: Vec<(String, String)>,
+}
+
+#[derive(Deserialize)]
+struct SymbolNames {
+    name: String,
+    #[serde(rename = "prettyName", default)]
+    pretty_name: String,
+}
+
+/// Read the names of each symbol as the symbol table is parsed, skipping over everything else
+/// rather than building the whole table in memory.
+fn collect_pretty_names<'de, D>(deserializer: D) -> Result<Vec<(String, String)>, D::Error>
+where
+    D: Deserializer<'de>,
+{
+    struct SymbolTableVisitor;
+
+    impl<'de> Visitor<'de> for SymbolTableVisitor {
+        type Value = Vec<(String, String)>;
+
+        fn expecting(&self, formatter: &mut std::fmt::Formatter) -> std::fmt::Result {
+            formatter.write_str("a map of symbols")
+        }
+
+        fn visit_map<A: MapAccess<'de>>(self, mut map: A) -> Result<Self::Value, A::Error> {
+            let mut pretty_names = Vec::new();
+            while let Some((IgnoredAny, symbol)) = map.next_entry::<IgnoredAny, SymbolNames>()? {
+                // Struct names start with "tag-", but this prefix is not used in the GotoC files, so we strip it.
+                // If there is no such prefix, we leave the name unchanged.
+                let name = symbol.name.strip_prefix("tag-").unwrap_or(&symbol.name);
+                if !symbol.pretty_name.is_empty() && symbol.pretty_name != name {
+                    pretty_names.push((name.to_string(), symbol.pretty_name));
+                }
+            }
+            Ok(pretty_names)
+        }
+    }
+
+    deserializer.deserialize_map(SymbolTableVisitor)
+}
+
+/// Copy C code from `reader` to `writer`, replacing every identifier that has a pretty name.
+/// The code is rewritten in a single pass over its identifiers, so a name is only replaced where
+/// it's a whole identifier, and never inside a pretty name that was substituted earlier.
+fn demangle_identifiers(
+    mut reader: impl BufRead,
+    writer: &mut impl Write,
+    pretty_names: &HashMap<String, String>,
+) -> Result<()> {
+    let is_identifier = |c: char| c.is_ascii_alphanumeric() || c == '_' || c == '$';
+    let mut line = String::new();
+    while reader.read_line(&mut line)? != 0 {
+        let mut rest = line.as_str();
+        while !rest.is_empty() {
+            let start = rest.find(is_identifier).unwrap_or(rest.len());
+            writer.write_all(rest[..start].as_bytes())?;
+            rest = &rest[start..];
+            let end = rest.find(|c| !is_identifier(c)).unwrap_or(rest.len());
+            let identifier = &rest[..end];
+            let demangled = pretty_names.get(identifier).map_or(identifier, String::as_str);
+            writer.write_all(demangled.as_bytes())?;
+            rest = &rest[end..];
+        }
+        line.clear();
+    }
+    Ok(())
+}
+
+/// Link the binary against the CBMC model for C library functions.
+/// Normally this happens implicitly, but we use this explicitly
+/// along with `undefined_functions_flags` below, otherwise these
+/// functions appear undefined.
+fn add_library_flags() -> Vec<OsString> {
+    vec!["--add-library".into()]
+}
+
+/// Instruct CBMC to "assert false" when invoking an undefined function.
+/// (This contrasts with its default behavior of returning `nondet`, which is
+/// unsound in the face of side-effects.)
+/// Then remove unused functions. (Oddly, it seems CBMC will both see some
+/// functions as unused and remove them, and also as used and so would
+/// generate "assert false". So it's essential to do this afterwards.)
+fn undefined_functions_flags() -> Vec<OsString> {
+    vec![
+        "--generate-function-body-options".into(),
+        "assert-false-assume-false".into(),
+        "--generate-function-body".into(),
+        ".*".into(),
+        "--drop-unused-functions".into(),
+    ]
+}
+
+/// Remove all functions unreachable from the current proof harness.
+fn just_drop_unused_functions_flags() -> Vec<OsString> {
+    vec!["--drop-unused-functions".into()]
+}
+
+fn rewrite_back_edges_flags() -> Vec<OsString> {
+    vec!["--ensure-one-backedge-per-target".into()]
+}
+
+fn goto_sanity_check_flags() -> Vec<OsString> {
+    vec!["--validate-goto-model".into()]
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn check_demangle_identifiers() {
+        let symtab = r#"{"symbolTable": {
+            "_RNvCs1_4test4main": {"name": "_RNvCs1_4test4main", "prettyName": "test::main", "value": {"id": "code"}},
+            "tag-_RNtCs1_4test3Foo": {"name": "tag-_RNtCs1_4test3Foo", "prettyName": "test::Foo"},
+            "x": {"name": "x", "prettyName": "x"},
+            "y": {"name": "y"}
+        }}"#;
+        let symtab: PrettyNames = serde_json::from_str(symtab).unwrap();
+        let pretty_names: HashMap<_, _> = symtab.pretty_names.into_iter().collect();
+        assert_eq!(pretty_names.len(), 2);
+
+        let code = "struct _RNtCs1_4test3Foo x;\nvoid _RNvCs1_4test4main(void) { _RNvCs1_4test4main_tmp = x; }\n";
+        let mut demangled = Vec::new();
+        demangle_identifiers(code.as_bytes(), &mut demangled, &pretty_names).unwrap();
+        assert_eq!(
+            String::from_utf8(demangled).unwrap(),
+            "struct test::Foo x;\nvoid test::main(void) { _RNvCs1_4test4main_tmp = x; }\n"
+        );
+    }
+}
@@ -0,0 +1,59 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use anyhow::Result;
+use kani_metadata::HarnessMetadata;
+use std::path::Path;
+use std::process::Command;
+
+use crate::call_cbmc::VerificationStatus;
+use crate::session::KaniSession;
+use crate::util::alter_extension;
+
+/// Iterations per harness when `--native-iterations` is not given.
+const DEFAULT_NATIVE_ITERATIONS: u64 = 1000;
+
+impl KaniSession {
+    /// Compile a goto binary that's been prepared with goto-instrument to a native executable and
+    /// run randomized iterations of the harness with it (i.e. --run-native).
+    ///
+    /// This is a cheap smoke test rather than verification: a failure is a real counterexample,
+    /// but success only means that none of the iterations we tried failed.
+    pub fn run_native(&self, file: &Path, harness: &HarnessMetadata) -> Result<VerificationStatus> {
+        let c_file = alter_extension(file, "native.c");
+        let executable = alter_extension(file, "native");
+
+        {
+            let mut temps = self.temporaries.lock().unwrap();
+            temps.push(c_file.clone());
+            temps.push(executable.clone());
+        }
+
+        self.gen_c(file, &c_file)?;
+
+        // gen_c_lib.c provides macros used by the generated code, so it has to be included
+        // rather than compiled separately. KANI_HARNESS selects the entry point of its driver.
+        let cc = std::env::var_os("CC").unwrap_or_else(|| "cc".into());
+        let mut cmd = Command::new(cc);
+        cmd.arg("-O2")
+            .arg("-include")
+            .arg(&self.gen_c_lib_c)
+            .arg(format!("-DKANI_HARNESS={}", harness.mangled_name))
+            .arg(&c_file)
+            .arg("-o")
+            .arg(&executable)
+            .arg("-lm");
+        self.run_suppress(cmd)?;
+
+        let mut cmd = Command::new(&executable);
+        cmd.arg(self.args.native_iterations.unwrap_or(DEFAULT_NATIVE_ITERATIONS).to_string());
+        if let Some(seed) = self.args.native_seed {
+            cmd.arg(seed.to_string());
+        }
+
+        if self.run_terminal(cmd).is_err() {
+            return Ok(VerificationStatus::Failure);
+        }
+        Ok(VerificationStatus::Success)
+    }
+}
@@ -14,7 +14,7 @@ pub struct SingleOutputs {
     /// The directory where compiler outputs should be directed.
     /// May be '.' or a path for 'kani', usually under 'target/' for 'cargo-kani'
     pub outdir: PathBuf,
-    /// The *.symtab.json written.
+    /// The *.symtab.json (or *.symtab.out) written.
     pub symtab: PathBuf,
     /// The vtable restrictions files, if any.
     pub restrictions: Option<PathBuf>,
@@ -27,14 +27,14 @@ impl KaniSession {
     pub fn compile_single_rust_file(&self, file: &Path) -> Result<SingleOutputs> {
         let outdir =
             file.canonicalize()?.parent().context("File doesn't exist in a directory?")?.to_owned();
-        let output_filename = alter_extension(file, "symtab.json");
+        let output_filename = alter_extension(file, self.symtab_extension());
         let typemap_filename = alter_extension(file, "type_map.json");
         let metadata_filename = alter_extension(file, "kani-metadata.json");
         let restrictions_filename = alter_extension(file, "restrictions.json");
         let rlib_filename = guess_rlib_name(file);
 
         {
-            let mut temps = self.temporaries.borrow_mut();
+            let mut temps = self.temporaries.lock().unwrap();
             temps.push(rlib_filename);
             temps.push(output_filename.clone());
             temps.push(typemap_filename);
@@ -120,6 +120,16 @@ pub fn kani_rustc_flags(&self) -> Vec<OsString> {
         if self.args.ignore_global_asm {
             flags.push("--ignore-global-asm".into());
         }
+        if self.args.write_goto_binary {
+            flags.push("--write-goto-binary".into());
+        }
+        if self.args.slice_harnesses {
+            flags.push("--slice-harnesses".into());
+        }
+        if self.args.run_native {
+            // Produce a symbol table that dumps to valid C.
+            flags.push("--symbol-table-passes=gen-c".into());
+        }
 
         // Stratification point!
         // Above are arguments that should be parsed by kani-compiler
@@ -131,7 +141,8 @@ pub fn kani_rustc_flags(&self) -> Vec<OsString> {
             flags.push("force-unstable-if-unmarked=yes".into()); // ??
             flags.push("--cfg=use_abs".into());
             flags.push("--cfg".into());
-            let abs_type = format!("abs_type={}", self.args.abs_type.to_string().to_lowercase());
+            let abs_type =
+                format!("abs_type=\"{}\"", self.args.abs_type.to_string().to_lowercase());
             flags.push(abs_type.into());
         }
 
@@ -8,12 +8,22 @@
 use crate::session::KaniSession;
 
 impl KaniSession {
-    /// Given a `file.symtab.json`, produce `{file}.symtab.out` by calling symtab2gb
+    /// The extension of the symbol tables written by kani-compiler
+    pub fn symtab_extension(&self) -> &'static str {
+        if self.args.write_goto_binary { "symtab.out" } else { "symtab.json" }
+    }
+
+    /// Given a `file.symtab.json`, produce `{file}.symtab.out` by calling symtab2gb.
+    /// With `--write-goto-binary`, kani-compiler already wrote `file.symtab.out` instead.
     pub fn symbol_table_to_gotoc(&self, file: &Path) -> Result<PathBuf> {
+        if self.args.write_goto_binary {
+            return Ok(file.to_owned());
+        }
+
         let output_filename = file.with_extension("out");
 
         {
-            let mut temps = self.temporaries.borrow_mut();
+            let mut temps = self.temporaries.lock().unwrap();
             temps.push(output_filename.clone());
         }
 
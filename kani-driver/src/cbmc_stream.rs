@@ -0,0 +1,279 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use anyhow::{Context, Result};
+use kani_metadata::HarnessMetadata;
+use std::io::{BufRead, BufReader, BufWriter, Read, Write};
+use std::os::unix::prelude::ExitStatusExt;
+use std::path::Path;
+use std::process::{Command, ExitStatus, Stdio};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::time::Duration;
+
+use crate::args::OutputFormat;
+use crate::perf_history::{peak_rss, CbmcRun};
+use crate::session::KaniSession;
+use crate::util::render_command;
+
+/// The longest interval between two polls of `run_streamed`
+const POLL_INTERVAL: Duration = Duration::from_millis(50);
+
+/// A check that CBMC reported as failed
+#[derive(Debug, PartialEq, Eq)]
+pub struct FailedCheck {
+    pub property: String,
+    pub description: String,
+}
+
+impl KaniSession {
+    /// Like `run_redirect`, but read the output of CBMC while it runs. With `--fail-fast`, the
+    /// checks that fail are reported as soon as CBMC prints them, a failure stops the verification
+    /// of the other harnesses, and this run is killed (and its `status` is that of a killed process)
+    /// if another harness fails first. This also measures the peak memory of CBMC, by polling it,
+    /// and kills it if it exceeds `--harness-memory-limit`.
+    pub fn run_streamed(
+        &self,
+        mut cmd: Command,
+        stdout: &Path,
+        harness: &HarnessMetadata,
+    ) -> Result<CbmcRun> {
+        if self.args.verbose || self.args.dry_run {
+            println!("{} > {}", render_command(&cmd).to_string_lossy(), stdout.display());
+            if self.args.dry_run {
+                // Short circuit, like `run_redirect`
+                let status = ExitStatus::from_raw(0);
+                return Ok(CbmcRun {
+                    status,
+                    peak_rss_kb: None,
+                    out_of_memory: false,
+                    solver: None,
+                });
+            }
+        }
+        let output_file = std::fs::File::create(&stdout)?;
+        cmd.stdout(Stdio::piped());
+        let mut child = cmd
+            .spawn()
+            .context(format!("Failed to invoke {}", cmd.get_program().to_string_lossy()))?;
+        let child_stdout = child.stdout.take().unwrap();
+
+        let found_failure = AtomicBool::new(false);
+        std::thread::scope(|scope| {
+            let reader = scope
+                .spawn(|| self.read_results(child_stdout, output_file, harness, &found_failure));
+
+            let limit_kb = self.args.harness_memory_limit.map(|mib| mib * 1024);
+            let mut peak_rss_kb = None;
+            let mut out_of_memory = false;
+            let mut interval = Duration::from_millis(1);
+            let status = loop {
+                if let Some(status) = child.try_wait()? {
+                    break status;
+                }
+                if self.verification_stopped() && !found_failure.load(Ordering::Relaxed) {
+                    // Another harness failed. The next poll collects the status.
+                    let _ = child.kill();
+                }
+                peak_rss_kb = peak_rss_kb.max(peak_rss(&child));
+                if limit_kb.is_some() && peak_rss_kb > limit_kb {
+                    out_of_memory = true;
+                    let _ = child.kill();
+                }
+                std::thread::sleep(interval);
+                // Poll quick runs often, and long ones less so.
+                interval = (interval * 2).min(POLL_INTERVAL);
+            };
+            reader.join().unwrap()?;
+            Ok(CbmcRun { status, peak_rss_kb, out_of_memory, solver: None })
+        })
+    }
+
+    /// Copy the output of CBMC to `output_file`. With `--fail-fast`, report each failed check as
+    /// CBMC prints it, and stop the verification of the other harnesses.
+    fn read_results(
+        &self,
+        output: impl Read,
+        output_file: std::fs::File,
+        harness: &HarnessMetadata,
+        found_failure: &AtomicBool,
+    ) -> Result<()> {
+        let mut output = BufReader::new(output);
+        let mut output_file = BufWriter::new(output_file);
+        let mut results = ResultStream::new(self.args.output_format == OutputFormat::Old);
+        let mut line = Vec::new();
+        while output.read_until(b'\n', &mut line)? > 0 {
+            output_file.write_all(&line)?;
+            for check in results.feed(&line) {
+                found_failure.store(true, Ordering::Relaxed);
+                if self.args.fail_fast {
+                    self.stop_verification();
+                    // Only with `--stop-on-fail` does CBMC print a failure before it exits.
+                    // Don't wait for `report_lock` here: another harness may hold it for its
+                    // whole report, and CBMC blocks once we stop draining its output.
+                    if !self.args.quiet {
+                        println!(
+                            "Found a failed check in {}: {} ({})",
+                            harness.pretty_name, check.description, check.property
+                        );
+                    }
+                }
+            }
+            line.clear();
+        }
+        output_file.flush()?;
+        Ok(())
+    }
+}
+
+/// Finds the failed checks in the output of CBMC, fed one line at a time.
+///
+/// In the old output format, CBMC prints each result on its own line, e.g.
+/// `[main.assertion.1] line 5 assertion failed: x == 2: FAILURE`.
+/// With `--json-ui`, it prints an array of messages, and the results are the objects in the
+/// `result` array of one of them. Those are 4 levels deep, so we only have to scan the output for
+/// brackets to find them, and only parse each result once it's complete.
+struct ResultStream {
+    old_format: bool,
+    depth: usize,
+    in_string: bool,
+    escaped: bool,
+    /// The JSON of the result being read, if any
+    result: Vec<u8>,
+}
+
+/// How deep the objects of the `result` array are nested in the output of `--json-ui`
+const RESULT_DEPTH: usize = 4;
+
+impl ResultStream {
+    fn new(old_format: bool) -> Self {
+        ResultStream { old_format, depth: 0, in_string: false, escaped: false, result: Vec::new() }
+    }
+
+    /// The checks that the results completed by `line` report as failed
+    fn feed(&mut self, line: &[u8]) -> Vec<FailedCheck> {
+        if self.old_format {
+            return old_format_failure(&String::from_utf8_lossy(line)).into_iter().collect();
+        }
+
+        let mut failures = Vec::new();
+        for &byte in line {
+            if self.depth >= RESULT_DEPTH {
+                self.result.push(byte);
+            }
+            if self.in_string {
+                match byte {
+                    _ if self.escaped => self.escaped = false,
+                    b'\\' => self.escaped = true,
+                    b'"' => self.in_string = false,
+                    _ => {}
+                }
+                continue;
+            }
+            match byte {
+                b'"' => self.in_string = true,
+                b'[' | b'{' => {
+                    self.depth += 1;
+                    if self.depth == RESULT_DEPTH {
+                        self.result.push(byte);
+                    }
+                }
+                b']' | b'}' => {
+                    self.depth = self.depth.saturating_sub(1);
+                    if self.depth + 1 == RESULT_DEPTH {
+                        failures.extend(json_failure(&self.result));
+                        self.result.clear();
+                    }
+                }
+                _ => {}
+            }
+        }
+        failures
+    }
+}
+
+/// The failed check of a result in the JSON output of CBMC, if it is one
+fn json_failure(result: &[u8]) -> Option<FailedCheck> {
+    let result: serde_json::Value = serde_json::from_slice(result).ok()?;
+    if result.get("status")? != "FAILURE" {
+        return None;
+    }
+    Some(FailedCheck {
+        property: result.get("property")?.as_str()?.to_string(),
+        description: result.get("description")?.as_str()?.to_string(),
+    })
+}
+
+/// The failed check of a line of the old output format of CBMC, if it is one
+fn old_format_failure(line: &str) -> Option<FailedCheck> {
+    let description = line.trim_end().strip_suffix(": FAILURE")?;
+    let (property, description) = description.strip_prefix('[')?.split_once("] ")?;
+    Some(FailedCheck { property: property.to_string(), description: description.to_string() })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn failures(old_format: bool, output: &str) -> Vec<FailedCheck> {
+        let mut results = ResultStream::new(old_format);
+        output.split_inclusive('\n').flat_map(|line| results.feed(line.as_bytes())).collect()
+    }
+
+    fn check(property: &str, description: &str) -> FailedCheck {
+        FailedCheck { property: property.to_string(), description: description.to_string() }
+    }
+
+    #[test]
+    fn check_json_failures() {
+        let output = r#"[
+  {
+    "program": "CBMC 5.60.0 (cbmc-5.60.0)"
+  },
+  {
+    "messageText": "Runtime Solver: 0.1s [result]",
+    "messageType": "STATUS-MESSAGE"
+  },
+  {
+    "result": [
+      {
+        "description": "assertion failed: x == 2",
+        "property": "main.assertion.1",
+        "status": "SUCCESS"
+      },
+      {
+        "description": "assertion failed: \"}\" != y",
+        "property": "main.assertion.2",
+        "status": "FAILURE",
+        "trace": [
+          {
+            "hidden": false,
+            "stepType": "assignment",
+            "value": { "data": "2", "name": "integer" }
+          }
+        ]
+      }
+    ]
+  },
+  {
+    "cProverStatus": "failure"
+  }
+]
+"#;
+        assert_eq!(
+            failures(false, output),
+            vec![check("main.assertion.2", "assertion failed: \"}\" != y")]
+        );
+    }
+
+    #[test]
+    fn check_old_format_failures() {
+        let output = "** Results:\n\
+                      [main.assertion.1] line 5 assertion failed: x == 2: SUCCESS\n\
+                      [main.assertion.2] line 6 assertion failed: y: 1: FAILURE\n\
+                      \n** 1 of 2 failed (2 iterations)\n";
+        assert_eq!(
+            failures(true, output),
+            vec![check("main.assertion.2", "line 6 assertion failed: y: 1")]
+        );
+    }
+}
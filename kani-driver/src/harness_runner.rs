@@ -0,0 +1,161 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use anyhow::Result;
+use kani_metadata::HarnessMetadata;
+use std::cmp::Reverse;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::{Mutex, MutexGuard};
+
+use crate::args::KaniArgs;
+use crate::call_cbmc::{resolve_unwind_value, VerificationStatus};
+use crate::memory_budget::MemoryBudget;
+use crate::perf_history::PerfHistory;
+use crate::session::KaniSession;
+
+impl KaniSession {
+    /// Run `verify` on each harness, on up to `--jobs` threads, and return the harnesses it
+    /// reported a failure for, in the order of `harnesses`.
+    ///
+    /// `verify` makes the goto binary of its harness, by specializing the linked binary of all
+    /// harnesses, or with `--slice-harnesses`, by linking the slice of the harness, and then
+    /// instruments and checks it. A thread picks up a new harness only once it is done with the
+    /// previous one, so that at most `--jobs` of these binaries, and CBMC processes, are alive at
+    /// any time.
+    ///
+    /// With `--fail-fast`, no harness is started once one failed. With `--memory-budget`, a thread
+    /// also waits to start a harness until it fits in the budget.
+    pub fn verify_harnesses<'a, F>(
+        &self,
+        harnesses: &'a [HarnessMetadata],
+        verify: F,
+    ) -> Result<Vec<&'a HarnessMetadata>>
+    where
+        F: Fn(&HarnessMetadata) -> Result<VerificationStatus> + Sync,
+    {
+        let jobs = self.args.jobs().min(harnesses.len());
+        if jobs <= 1 {
+            let mut failed_harnesses = Vec::new();
+            for harness in harnesses {
+                if verify(harness)? == VerificationStatus::Failure {
+                    failed_harnesses.push(harness);
+                    if self.args.fail_fast {
+                        self.stop_verification();
+                        break;
+                    }
+                }
+            }
+            self.save_perf_history()?;
+            return Ok(failed_harnesses);
+        }
+
+        let order = schedule(&self.args, &self.perf_history.lock().unwrap(), harnesses);
+        let budget = self.args.memory_budget.map(|mib| MemoryBudget::new(mib * 1024));
+        let next = AtomicUsize::new(0);
+        let aborted = AtomicBool::new(false);
+        let results: Mutex<Vec<Option<Result<VerificationStatus>>>> =
+            Mutex::new(harnesses.iter().map(|_| None).collect());
+
+        std::thread::scope(|scope| {
+            for _ in 0..jobs {
+                scope.spawn(|| {
+                    while !aborted.load(Ordering::Relaxed) && !self.verification_stopped() {
+                        let index = match order.get(next.fetch_add(1, Ordering::Relaxed)) {
+                            Some(&index) => index,
+                            None => break,
+                        };
+                        let _reservation = budget.as_ref().map(|budget| {
+                            budget.admit(|| self.memory_estimate_kb(&harnesses[index]))
+                        });
+                        let result = verify(&harnesses[index]);
+                        // Like the sequential loop, don't start any harness after an error.
+                        match result {
+                            Err(_) => aborted.store(true, Ordering::Relaxed),
+                            Ok(VerificationStatus::Failure) if self.args.fail_fast => {
+                                self.stop_verification()
+                            }
+                            _ => {}
+                        }
+                        results.lock().unwrap()[index] = Some(result);
+                    }
+                });
+            }
+        });
+
+        let mut failed_harnesses = Vec::new();
+        for (harness, result) in harnesses.iter().zip(results.into_inner().unwrap()) {
+            match result {
+                Some(Ok(VerificationStatus::Failure)) => failed_harnesses.push(harness),
+                Some(Err(error)) => return Err(error),
+                // Verified, or never started or stopped because of an error or a failure
+                Some(Ok(VerificationStatus::Success | VerificationStatus::Stopped)) | None => {}
+            }
+        }
+        self.save_perf_history()?;
+        Ok(failed_harnesses)
+    }
+
+    /// Start printing the results of `harness`. Until the returned guard is dropped, the results
+    /// of other harnesses are held back. When harnesses are verified concurrently, whose results
+    /// these are is only announced now, rather than when the harness started.
+    pub fn start_report(&self, harness: &HarnessMetadata) -> MutexGuard<'_, ()> {
+        let guard = self.report_lock.lock().unwrap();
+        if self.args.jobs() > 1 && !self.args.quiet {
+            println!("Checking harness {}...", harness.pretty_name);
+        }
+        guard
+    }
+
+    /// Stop verifying harnesses, because one failed with `--fail-fast`. This kills the CBMC runs
+    /// of the other harnesses, in `run_streamed`.
+    pub fn stop_verification(&self) {
+        self.verification_stopped.store(true, Ordering::Relaxed);
+    }
+
+    pub fn verification_stopped(&self) -> bool {
+        self.verification_stopped.load(Ordering::Relaxed)
+    }
+}
+
+/// The order in which to start verifying the harnesses: the ones expected to take longest
+/// first, so that no long harness is started last, when the other threads have run out of
+/// work. Harnesses are ordered by how long they took in the performance history, if they are in
+/// it, and then by how far their loops are unwound. Those that are not in the history come first,
+/// since they may take any time.
+fn schedule(args: &KaniArgs, history: &PerfHistory, harnesses: &[HarnessMetadata]) -> Vec<usize> {
+    let mut order: Vec<usize> = (0..harnesses.len()).collect();
+    order.sort_by_key(|&index| {
+        let harness = &harnesses[index];
+        let recorded_ms = history.time(harness).map_or(u64::MAX, |time| (time * 1000.0) as u64);
+        Reverse((recorded_ms, resolve_unwind_value(args, harness), harness.vec_capacity))
+    });
+    order
+}
+
+#[cfg(test)]
+mod tests {
+    use crate::metadata::mock_proof_harness;
+    use crate::perf_history::HarnessPerf;
+    use structopt::StructOpt;
+
+    use super::*;
+
+    #[test]
+    fn check_schedule() {
+        let harnesses = vec![
+            mock_proof_harness("no_loops", None),
+            mock_proof_harness("long", Some(10)),
+            mock_proof_harness("short", Some(2)),
+        ];
+        let history = PerfHistory::default();
+        let args = KaniArgs::from_iter(["kani"]);
+        assert_eq!(schedule(&args, &history, &harnesses), vec![1, 2, 0]);
+        let args = KaniArgs::from_iter(["kani", "--default-unwind", "5"]);
+        assert_eq!(schedule(&args, &history, &harnesses), vec![1, 0, 2]);
+
+        let mut history = PerfHistory::default();
+        history.insert(&harnesses[0], HarnessPerf { time: 3.0, ..Default::default() });
+        history.insert(&harnesses[2], HarnessPerf { time: 30.0, ..Default::default() });
+        assert_eq!(schedule(&args, &history, &harnesses), vec![1, 2, 0]);
+    }
+}
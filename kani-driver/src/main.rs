@@ -19,11 +19,18 @@
 mod call_display_results;
 mod call_goto_cc;
 mod call_goto_instrument;
+mod call_native;
 mod call_single_file;
 mod call_symtab;
+mod cbmc_stream;
+mod harness_runner;
+mod memory_budget;
 mod metadata;
+mod perf_history;
 mod session;
+mod solver_portfolio;
 mod util;
+mod verification_cache;
 
 fn main() -> Result<()> {
     match determine_invocation_type(Vec::from_iter(std::env::args_os())) {
@@ -47,34 +54,34 @@ fn cargokani_main(input_args: Vec<OsString>) -> Result<()> {
         goto_objs.push(ctx.symbol_table_to_gotoc(symtab)?);
     }
 
+    let metadata = ctx.collect_kani_metadata(&outputs.metadata)?;
     let linked_obj = outputs.outdir.join("cbmc-linked.out");
-    ctx.link_goto_binary(&goto_objs, &linked_obj)?;
-    if let Some(restrictions) = outputs.restrictions {
-        ctx.apply_vtable_restrictions(&linked_obj, &restrictions)?;
+    if !ctx.args.slice_harnesses {
+        ctx.link_goto_binary(&goto_objs, &linked_obj, &metadata.undefined_functions)?;
+        if let Some(restrictions) = &outputs.restrictions {
+            ctx.apply_vtable_restrictions(&linked_obj, restrictions)?;
+        }
     }
 
-    let metadata = ctx.collect_kani_metadata(&outputs.metadata)?;
     let harnesses = ctx.determine_targets(&metadata)?;
     let report_base = ctx.args.target_dir.clone().unwrap_or(PathBuf::from("target"));
 
-    let mut failed_harnesses: Vec<&HarnessMetadata> = Vec::new();
-
-    for harness in &harnesses {
+    let failed_harnesses = ctx.verify_harnesses(&harnesses, |harness| {
         let harness_filename = harness.pretty_name.replace("::", "-");
         let report_dir = report_base.join(format!("report-{}", harness_filename));
         let specialized_obj = outputs.outdir.join(format!("cbmc-for-{}.out", harness_filename));
-        ctx.run_goto_instrument(
-            &linked_obj,
-            &specialized_obj,
-            &outputs.symtabs,
-            &harness.mangled_name,
-        )?;
-
-        let result = ctx.check_harness(&specialized_obj, &report_dir, harness)?;
-        if result == VerificationStatus::Failure {
-            failed_harnesses.push(harness);
+        if harness.goto_file.is_some() {
+            ctx.link_harness_slice(
+                &goto_objs,
+                &metadata.undefined_functions,
+                harness,
+                &specialized_obj,
+            )?;
         }
-    }
+        ctx.run_goto_instrument(&linked_obj, &specialized_obj, &outputs.symtabs, harness)?;
+
+        ctx.check_harness(&specialized_obj, &report_dir, harness)
+    })?;
 
     ctx.print_final_summary(&harnesses, &failed_harnesses)
 }
@@ -92,40 +99,42 @@ fn standalone_main() -> Result<()> {
 
     let linked_obj = util::alter_extension(&args.input, "out");
     {
-        let mut temps = ctx.temporaries.borrow_mut();
+        let mut temps = ctx.temporaries.lock().unwrap();
         temps.push(linked_obj.to_owned());
     }
-    ctx.link_goto_binary(&[goto_obj], &linked_obj)?;
-    if let Some(restriction) = outputs.restrictions {
-        ctx.apply_vtable_restrictions(&linked_obj, &restriction)?;
+    let metadata = ctx.collect_kani_metadata(&[outputs.metadata])?;
+    let goto_objs = [goto_obj];
+    if !ctx.args.slice_harnesses {
+        ctx.link_goto_binary(&goto_objs, &linked_obj, &metadata.undefined_functions)?;
+        if let Some(restriction) = &outputs.restrictions {
+            ctx.apply_vtable_restrictions(&linked_obj, restriction)?;
+        }
     }
 
-    let metadata = ctx.collect_kani_metadata(&[outputs.metadata])?;
     let harnesses = ctx.determine_targets(&metadata)?;
     let report_base = ctx.args.target_dir.clone().unwrap_or(PathBuf::from("."));
 
-    let mut failed_harnesses: Vec<&HarnessMetadata> = Vec::new();
-
-    for harness in &harnesses {
+    let failed_harnesses = ctx.verify_harnesses(&harnesses, |harness| {
         let harness_filename = harness.pretty_name.replace("::", "-");
         let report_dir = report_base.join(format!("report-{}", harness_filename));
         let specialized_obj = append_path(&linked_obj, &format!("for-{}", harness_filename));
         {
-            let mut temps = ctx.temporaries.borrow_mut();
+            let mut temps = ctx.temporaries.lock().unwrap();
             temps.push(specialized_obj.to_owned());
         }
-        ctx.run_goto_instrument(
-            &linked_obj,
-            &specialized_obj,
-            &[&outputs.symtab],
-            &harness.mangled_name,
-        )?;
-
-        let result = ctx.check_harness(&specialized_obj, &report_dir, harness)?;
-        if result == VerificationStatus::Failure {
-            failed_harnesses.push(harness);
+        if let Some(slice) = &harness.goto_file {
+            ctx.temporaries.lock().unwrap().push(slice.into());
+            ctx.link_harness_slice(
+                &goto_objs,
+                &metadata.undefined_functions,
+                harness,
+                &specialized_obj,
+            )?;
         }
-    }
+        ctx.run_goto_instrument(&linked_obj, &specialized_obj, &[&outputs.symtab], harness)?;
+
+        ctx.check_harness(&specialized_obj, &report_dir, harness)
+    })?;
 
     ctx.print_final_summary(&harnesses, &failed_harnesses)
 }
@@ -137,7 +146,8 @@ fn check_harness(
         report_dir: &Path,
         harness: &HarnessMetadata,
     ) -> Result<VerificationStatus> {
-        if !self.args.quiet {
+        // With several jobs, `start_report` announces the harness along with its results.
+        if !self.args.quiet && self.args.jobs() == 1 {
             println!("Checking harness {}...", harness.pretty_name);
         }
 
@@ -145,6 +155,8 @@ fn check_harness(
             self.run_visualize(binary, report_dir, harness)?;
             // Strictly speaking, we're faking success here. This is more "no error"
             Ok(VerificationStatus::Success)
+        } else if self.args.run_native {
+            self.run_native(binary, harness)
         } else {
             self.run_cbmc(binary, harness)
         }
@@ -163,12 +175,20 @@ fn print_final_summary(
                 println!("Verification failed for - {}", harness.pretty_name);
             }
 
-            println!(
-                "Complete - {} successfully verified harnesses, {} failures, {} total.",
-                harnesses.len() - failed_harnesses.len(),
-                failed_harnesses.len(),
-                harnesses.len()
-            );
+            if self.verification_stopped() {
+                println!(
+                    "Stopped at the first failure - {} failures, {} total.",
+                    failed_harnesses.len(),
+                    harnesses.len()
+                );
+            } else {
+                println!(
+                    "Complete - {} successfully verified harnesses, {} failures, {} total.",
+                    harnesses.len() - failed_harnesses.len(),
+                    failed_harnesses.len(),
+                    harnesses.len()
+                );
+            }
         }
 
         if !failed_harnesses.is_empty() {
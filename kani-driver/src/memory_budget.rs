@@ -0,0 +1,166 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use kani_metadata::HarnessMetadata;
+use std::collections::HashMap;
+use std::sync::atomic::Ordering;
+use std::sync::Mutex;
+use std::time::Duration;
+
+use crate::session::KaniSession;
+
+/// How often to check whether the next harness fits in `--memory-budget`
+const ADMISSION_POLL_INTERVAL: Duration = Duration::from_millis(100);
+
+/// The memory of the harnesses being verified, with `--memory-budget`
+pub struct MemoryBudget {
+    budget_kb: u64,
+    /// How many harnesses are being verified, and their expected peak memory, added up
+    reserved: Mutex<(usize, u64)>,
+    /// Held while a harness waits to fit in the budget, so harnesses start in order, and a large
+    /// one isn't overtaken forever by smaller ones
+    queue: Mutex<()>,
+}
+
+/// The memory reserved for a harness being verified, freed when it is dropped
+pub struct Reservation<'a> {
+    budget: &'a MemoryBudget,
+    estimate_kb: u64,
+}
+
+impl MemoryBudget {
+    pub fn new(budget_kb: u64) -> Self {
+        MemoryBudget { budget_kb, reserved: Mutex::new((0, 0)), queue: Mutex::new(()) }
+    }
+
+    /// Wait until a harness that may use `estimate_kb()` at its peak fits in the budget, and
+    /// reserve that memory for it. The memory in use is what the running harnesses reserved, or
+    /// what the processes we started use, if that's more. The estimate is asked for again while
+    /// waiting, as finished harnesses may have measured one.
+    pub fn admit(&self, estimate_kb: impl Fn() -> Option<u64>) -> Reservation<'_> {
+        let _queue = self.queue.lock().unwrap();
+        loop {
+            {
+                let mut reserved = self.reserved.lock().unwrap();
+                let (running, reserved_kb) = *reserved;
+                let used_kb = reserved_kb.max(children_rss_kb());
+                let estimate = estimate_kb();
+                if fits(self.budget_kb, used_kb, estimate, running) {
+                    let estimate_kb = estimate.unwrap_or(0);
+                    *reserved = (running + 1, reserved_kb + estimate_kb);
+                    return Reservation { budget: self, estimate_kb };
+                }
+            }
+            std::thread::sleep(ADMISSION_POLL_INTERVAL);
+        }
+    }
+}
+
+impl Drop for Reservation<'_> {
+    fn drop(&mut self) {
+        let mut reserved = self.budget.reserved.lock().unwrap();
+        *reserved = (reserved.0 - 1, reserved.1 - self.estimate_kb);
+    }
+}
+
+/// Whether a harness that may use `estimate_kb` can start while `running` harnesses use
+/// `used_kb`. A harness always starts when no other is running, so that one larger than the
+/// budget is still verified, alone. One we have no estimate for only starts then: the memory of
+/// the processes we started is measured too late to stop all the harnesses from starting at once.
+fn fits(budget_kb: u64, used_kb: u64, estimate_kb: Option<u64>, running: usize) -> bool {
+    match estimate_kb {
+        Some(estimate_kb) => running == 0 || used_kb + estimate_kb <= budget_kb,
+        None => running == 0,
+    }
+}
+
+impl KaniSession {
+    /// The memory that verifying `harness` may take at its peak: what it took when it was
+    /// recorded by `--perf-history`, or else `--harness-memory-limit`, which it can't exceed, or
+    /// else the most any CBMC run took so far. Before a run was measured, we know nothing.
+    pub fn memory_estimate_kb(&self, harness: &HarnessMetadata) -> Option<u64> {
+        self.recorded_perf(harness)
+            .and_then(|perf| perf.peak_rss_kb)
+            .or_else(|| self.args.harness_memory_limit.map(|mib| mib * 1024))
+            .or_else(|| match self.peak_rss_kb.load(Ordering::Relaxed) {
+                0 => None,
+                peak_rss_kb => Some(peak_rss_kb),
+            })
+    }
+}
+
+/// The resident memory of the processes we started, e.g. `cbmc` and `goto-instrument`, and the
+/// ones they started, in KB. Only Linux reports it.
+fn children_rss_kb() -> u64 {
+    let mut parents = HashMap::new();
+    if let Ok(entries) = std::fs::read_dir("/proc") {
+        for entry in entries.flatten() {
+            // Processes are the directories named after their pid.
+            let pid = match entry.file_name().to_str().and_then(|name| name.parse::<u32>().ok()) {
+                Some(pid) => pid,
+                None => continue,
+            };
+            let stat = std::fs::read_to_string(entry.path().join("stat")).unwrap_or_default();
+            if let Some(ppid) = stat_ppid(&stat) {
+                parents.insert(pid, ppid);
+            }
+        }
+    }
+    descendants(&parents, std::process::id())
+        .into_iter()
+        .filter_map(|pid| {
+            let status = std::fs::read_to_string(format!("/proc/{}/status", pid)).ok()?;
+            let line = status.lines().find(|line| line.starts_with("VmRSS:"))?;
+            line.split_whitespace().nth(1)?.parse::<u64>().ok()
+        })
+        .sum()
+}
+
+/// The parent of a process, from its `/proc/<pid>/stat`, e.g. `42 (cbmc) S 41 ...`. The name of
+/// the process may contain spaces and parentheses, so we skip to the last parenthesis.
+fn stat_ppid(stat: &str) -> Option<u32> {
+    let (_, rest) = stat.rsplit_once(')')?;
+    rest.split_whitespace().nth(1)?.parse().ok()
+}
+
+/// The processes started by `root`, directly or not, given the parent of each process
+fn descendants(parents: &HashMap<u32, u32>, root: u32) -> Vec<u32> {
+    let mut found = vec![root];
+    let mut index = 0;
+    while index < found.len() {
+        let parent = found[index];
+        found.extend(parents.iter().filter(|(_, ppid)| **ppid == parent).map(|(pid, _)| *pid));
+        index += 1;
+    }
+    found.remove(0);
+    found
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn check_fits() {
+        assert!(fits(1000, 0, Some(2000), 0));
+        assert!(!fits(1000, 200, Some(900), 1));
+        assert!(fits(1000, 200, Some(800), 3));
+        assert!(fits(1000, 0, None, 0));
+        assert!(!fits(1000, 0, None, 1));
+    }
+
+    #[test]
+    fn check_stat_ppid() {
+        assert_eq!(stat_ppid("42 (cbmc) S 41 42 41 0 -1"), Some(41));
+        assert_eq!(stat_ppid("43 (a (b) c) R 7 43 7 0 -1"), Some(7));
+        assert_eq!(stat_ppid("44 (cbmc"), None);
+    }
+
+    #[test]
+    fn check_descendants() {
+        let parents = HashMap::from([(2, 1), (3, 2), (4, 1), (5, 9), (1, 0)]);
+        let mut found = descendants(&parents, 1);
+        found.sort();
+        assert_eq!(found, vec![2, 3, 4]);
+    }
+}
@@ -20,6 +20,9 @@ fn generate_mock_harness() -> HarnessMetadata {
         original_file: String::from("target_file.rs"),
         original_line: String::from("0"),
         unwind_value: None,
+        vec_capacity: None,
+        goto_file: None,
+        undefined_functions: vec![],
     }
 }
 
@@ -107,11 +110,16 @@ fn read_kani_metadata(path: &Path) -> Result<KaniMetadata> {
 
 /// Consumes a vector of parsed metadata, and produces a combined structure
 fn merge_kani_metadata(files: Vec<KaniMetadata>) -> KaniMetadata {
-    let mut result = KaniMetadata { proof_harnesses: Vec::new() };
+    let mut result = KaniMetadata { proof_harnesses: Vec::new(), undefined_functions: Vec::new() };
     for md in files {
         // Note that we're taking ownership of the original vec, and so we can move the data into the new data structure.
         result.proof_harnesses.extend(md.proof_harnesses);
+        result.undefined_functions.extend(md.undefined_functions);
     }
+    // A function one crate calls may be defined by another, but that doesn't matter to us: we
+    // only look for functions that no crate defines because they are provided in C.
+    result.undefined_functions.sort();
+    result.undefined_functions.dedup();
     result
 }
 
@@ -120,7 +128,10 @@ impl KaniSession {
     pub fn collect_kani_metadata(&self, files: &[PathBuf]) -> Result<KaniMetadata> {
         if self.args.dry_run {
             // Mock an answer
-            Ok(KaniMetadata { proof_harnesses: vec![generate_mock_harness()] })
+            Ok(KaniMetadata {
+                proof_harnesses: vec![generate_mock_harness()],
+                undefined_functions: Vec::new(),
+            })
         } else {
             // TODO: one possible future improvement here would be to return some kind of Lazy
             // value, that only computes this metadata if it turns out we need it.
@@ -157,6 +168,9 @@ pub fn mock_proof_harness(name: &str, unwind_value: Option<u32>) -> HarnessMetad
         original_file: "<unknown>".into(),
         original_line: "<unknown>".into(),
         unwind_value,
+        vec_capacity: None,
+        goto_file: None,
+        undefined_functions: vec![],
     }
 }
 
@@ -0,0 +1,172 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use anyhow::{Context, Result};
+use kani_metadata::HarnessMetadata;
+use serde::{Deserialize, Serialize};
+use std::collections::BTreeMap;
+use std::path::Path;
+use std::process::{Child, ExitStatus};
+
+use crate::session::KaniSession;
+
+/// A harness is reported as slower once it takes this many times as long as its recorded run...
+const SLOWDOWN_FACTOR: f32 = 2.0;
+/// ...and at least this many seconds more, so that noise on quick harnesses is not reported
+const SLOWDOWN_MIN_SECS: f32 = 1.0;
+
+/// The costs of the last successful verification of each harness, stored by `--perf-history`
+#[derive(Default, Serialize, Deserialize)]
+pub struct PerfHistory {
+    harnesses: BTreeMap<String, HarnessPerf>,
+    /// The harnesses that took much longer than their recorded run, reported at the end
+    #[serde(skip)]
+    slowdowns: Vec<String>,
+}
+
+/// The cost of verifying a harness
+#[derive(Clone, Debug, Default, PartialEq, Serialize, Deserialize)]
+pub struct HarnessPerf {
+    /// Wall-clock time of the CBMC run, in seconds
+    pub time: f32,
+    /// Time spent in symbolic execution, as reported by CBMC, in seconds
+    pub symex_time: Option<f32>,
+    /// Time spent in the solver, as reported by CBMC, in seconds
+    pub solver_time: Option<f32>,
+    /// Verification conditions left after simplification
+    pub vccs: Option<u64>,
+    /// Peak resident memory of CBMC, where it can be measured
+    pub peak_rss_kb: Option<u64>,
+    /// The `--solver-portfolio` configuration that finished first
+    pub solver: Option<String>,
+}
+
+/// A run of CBMC, as observed by `run_streamed` or `run_solver_portfolio`
+pub struct CbmcRun {
+    pub status: ExitStatus,
+    pub peak_rss_kb: Option<u64>,
+    /// Whether CBMC was killed for exceeding `--harness-memory-limit`
+    pub out_of_memory: bool,
+    /// The portfolio configuration that verified the harness
+    pub solver: Option<&'static str>,
+}
+
+impl PerfHistory {
+    /// Load the history in `path`, or start an empty one if there's no such file
+    pub fn load(path: &Path) -> Result<PerfHistory> {
+        if !path.exists() {
+            return Ok(PerfHistory::default());
+        }
+        let reader = std::io::BufReader::new(std::fs::File::open(path)?);
+        serde_json::from_reader(reader).context(format!("Failed to read {}", path.display()))
+    }
+
+    /// How long verifying `harness` took when it was recorded
+    pub fn time(&self, harness: &HarnessMetadata) -> Option<f32> {
+        self.harnesses.get(&harness.pretty_name).map(|perf| perf.time)
+    }
+
+    pub fn insert(&mut self, harness: &HarnessMetadata, perf: HarnessPerf) {
+        self.harnesses.insert(harness.pretty_name.clone(), perf);
+    }
+}
+
+impl KaniSession {
+    /// The recorded cost of verifying `harness`, with `--perf-history`
+    pub fn recorded_perf(&self, harness: &HarnessMetadata) -> Option<HarnessPerf> {
+        self.perf_history.lock().unwrap().harnesses.get(&harness.pretty_name).cloned()
+    }
+
+    /// Record the cost of a CBMC run that verified `harness` in `elapsed` seconds, along with the
+    /// statistics CBMC printed to `output_filename`
+    pub fn record_perf(
+        &self,
+        harness: &HarnessMetadata,
+        output_filename: &Path,
+        run: &CbmcRun,
+        elapsed: f32,
+    ) -> Result<()> {
+        if self.args.perf_history.is_none() || self.args.dry_run {
+            return Ok(());
+        }
+        let output = std::fs::read_to_string(output_filename)?;
+        let perf = HarnessPerf {
+            time: elapsed,
+            symex_time: cbmc_statistic(&output, "Runtime Symex: "),
+            solver_time: cbmc_statistic(&output, "Runtime Solver: "),
+            vccs: cbmc_statistic(&output, "VCC(s), "),
+            peak_rss_kb: run.peak_rss_kb,
+            solver: run.solver.map(str::to_string),
+        };
+
+        let mut history = self.perf_history.lock().unwrap();
+        if let Some(recorded) = history.harnesses.get(&harness.pretty_name) {
+            if elapsed > recorded.time * SLOWDOWN_FACTOR
+                && elapsed - recorded.time > SLOWDOWN_MIN_SECS
+            {
+                let slowdown = format!(
+                    "{} took {:.1}s, up from {:.1}s",
+                    harness.pretty_name, elapsed, recorded.time
+                );
+                history.slowdowns.push(slowdown);
+            }
+        }
+        history.insert(harness, perf);
+        Ok(())
+    }
+
+    /// Warn about the harnesses that got slower, and write the history back to `--perf-history`
+    pub fn save_perf_history(&self) -> Result<()> {
+        let path = match &self.args.perf_history {
+            Some(path) if !self.args.dry_run => path,
+            _ => return Ok(()),
+        };
+        let history = self.perf_history.lock().unwrap();
+        if !history.slowdowns.is_empty() && !self.args.quiet {
+            println!("Warning: some harnesses took much longer than in {}:", path.display());
+            for slowdown in &history.slowdowns {
+                println!(" - {}", slowdown);
+            }
+        }
+
+        // Write to a process-specific file and rename it into place, so that concurrent Kani runs
+        // never observe a partially written history.
+        let tmp = crate::util::append_path(path, &std::process::id().to_string());
+        serde_json::to_writer_pretty(std::fs::File::create(&tmp)?, &*history)?;
+        std::fs::rename(&tmp, path)?;
+        Ok(())
+    }
+}
+
+/// The peak resident memory of a running process so far, in KB. Only Linux reports it.
+pub fn peak_rss(child: &Child) -> Option<u64> {
+    let status = std::fs::read_to_string(format!("/proc/{}/status", child.id())).ok()?;
+    let line = status.lines().find(|line| line.starts_with("VmHWM:"))?;
+    line.split_whitespace().nth(1)?.parse().ok()
+}
+
+/// The number that follows the last occurrence of `prefix` in the output of CBMC, in either
+/// output format, e.g. `Runtime Symex: 0.25s`
+fn cbmc_statistic<T: std::str::FromStr>(output: &str, prefix: &str) -> Option<T> {
+    let start = output.rfind(prefix)? + prefix.len();
+    let rest = &output[start..];
+    let len = rest.find(|c: char| !c.is_ascii_digit() && c != '.').unwrap_or(rest.len());
+    rest[..len].parse().ok()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn check_cbmc_statistic() {
+        let output = r#"{ "messageText": "Runtime Symex: 0.25s" },
+            { "messageText": "Generated 12 VCC(s), 3 remaining after simplification" },
+            { "messageText": "Runtime Solver: 1.5s" },
+            { "messageText": "Runtime Solver: 2.5s" }"#;
+        assert_eq!(cbmc_statistic(output, "Runtime Symex: "), Some(0.25));
+        assert_eq!(cbmc_statistic(output, "Runtime Solver: "), Some(2.5));
+        assert_eq!(cbmc_statistic::<u64>(output, "VCC(s), "), Some(3));
+        assert_eq!(cbmc_statistic::<f32>(output, "Runtime Postprocess Equation: "), None);
+    }
+}
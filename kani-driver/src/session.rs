@@ -2,12 +2,14 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
 use crate::args::KaniArgs;
+use crate::perf_history::PerfHistory;
 use crate::util::render_command;
 use anyhow::{bail, Context, Result};
-use std::cell::RefCell;
 use std::io::Write;
 use std::path::{Path, PathBuf};
 use std::process::{Command, ExitStatus};
+use std::sync::atomic::{AtomicBool, AtomicU64};
+use std::sync::Mutex;
 
 /// Contains information about the execution environment and arguments that affect operations
 pub struct KaniSession {
@@ -20,6 +22,10 @@ pub struct KaniSession {
     pub kani_lib_c: PathBuf,
     /// The location we found the Kani C stub .c files
     pub kani_c_stubs: PathBuf,
+    /// The location where goto objects for 'kani_lib.c' and the C stubs are cached
+    pub kani_c_lib_cache: PathBuf,
+    /// The location we found 'gen_c_lib.c'
+    pub gen_c_lib_c: PathBuf,
     /// The location we found 'cbmc_json_parser.py'
     pub cbmc_json_parser_py: PathBuf,
 
@@ -27,7 +33,18 @@ pub struct KaniSession {
     pub kani_rlib: Option<PathBuf>,
 
     /// The temporary files we littered that need to be cleaned up at the end of execution
-    pub temporaries: RefCell<Vec<PathBuf>>,
+    pub temporaries: Mutex<Vec<PathBuf>>,
+    /// Held while the results of a harness are printed, so that the results of harnesses verified
+    /// concurrently do not interleave
+    pub report_lock: Mutex<()>,
+    /// The recorded costs of verifying harnesses, with `--perf-history`
+    pub perf_history: Mutex<PerfHistory>,
+    /// Set with `--fail-fast` once a harness failed, to stop verifying the others
+    pub verification_stopped: AtomicBool,
+    /// The version of CBMC, once `cbmc_version` asked for it
+    pub cbmc_version: Mutex<Option<String>>,
+    /// The most memory a CBMC run took so far, in KB, or 0 before one was measured
+    pub peak_rss_kb: AtomicU64,
 }
 
 /// Represents where we detected Kani, with helper methods for using that information to find critical paths
@@ -43,15 +60,26 @@ enum InstallType {
 impl KaniSession {
     pub fn new(args: KaniArgs) -> Result<Self> {
         let install = InstallType::new()?;
+        let perf_history = match &args.perf_history {
+            Some(path) => PerfHistory::load(path)?,
+            None => PerfHistory::default(),
+        };
 
         Ok(KaniSession {
             args,
             kani_compiler: install.kani_compiler()?,
             kani_lib_c: install.kani_lib_c()?,
             kani_c_stubs: install.kani_c_stubs()?,
+            kani_c_lib_cache: install.kani_c_lib_cache(),
+            gen_c_lib_c: install.gen_c_lib_c()?,
             cbmc_json_parser_py: install.cbmc_json_parser_py()?,
             kani_rlib: install.kani_rlib()?,
-            temporaries: RefCell::new(vec![]),
+            temporaries: Mutex::new(vec![]),
+            report_lock: Mutex::new(()),
+            perf_history: Mutex::new(perf_history),
+            verification_stopped: AtomicBool::new(false),
+            cbmc_version: Mutex::new(None),
+            peak_rss_kb: AtomicU64::new(0),
         })
     }
 }
@@ -59,7 +87,7 @@ pub fn new(args: KaniArgs) -> Result<Self> {
 impl Drop for KaniSession {
     fn drop(&mut self) {
         if !self.args.keep_temps && !self.args.dry_run {
-            let temporaries = self.temporaries.borrow();
+            let temporaries = self.temporaries.lock().unwrap();
 
             for file in temporaries.iter() {
                 // If it fails, we don't care, skip it
@@ -188,10 +216,22 @@ pub fn kani_lib_c(&self) -> Result<PathBuf> {
         self.base_path_with("library/kani/kani_lib.c")
     }
 
+    pub fn gen_c_lib_c(&self) -> Result<PathBuf> {
+        self.base_path_with("library/kani/gen_c_lib.c")
+    }
+
     pub fn kani_c_stubs(&self) -> Result<PathBuf> {
         self.base_path_with("library/kani/stubs/C")
     }
 
+    /// Unlike the other paths, the cache is created on demand, so it need not exist yet.
+    pub fn kani_c_lib_cache(&self) -> PathBuf {
+        match self {
+            Self::DevRepo(repo) => repo.join("target/kani-cache/goto"),
+            Self::Release(release) => release.join("cache/goto"),
+        }
+    }
+
     pub fn cbmc_json_parser_py(&self) -> Result<PathBuf> {
         self.base_path_with("scripts/cbmc_json_parser.py")
     }
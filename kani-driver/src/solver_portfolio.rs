@@ -0,0 +1,201 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use anyhow::{Context, Result};
+use kani_metadata::HarnessMetadata;
+use std::ffi::OsString;
+use std::os::unix::prelude::ExitStatusExt;
+use std::path::{Path, PathBuf};
+use std::process::{Child, Command, ExitStatus, Stdio};
+use std::time::Duration;
+
+use crate::perf_history::{peak_rss, CbmcRun};
+use crate::session::KaniSession;
+use crate::util::render_command;
+
+/// A configuration of CBMC that `--solver-portfolio` runs against the others
+struct SolverConfig {
+    name: &'static str,
+    /// Flags added to the ones from `cbmc_flags`
+    flags: &'static [&'static str],
+    /// Whether to keep `--slice-formula`
+    slice_formula: bool,
+}
+
+/// The configurations of `--solver-portfolio`, the default one first
+const PORTFOLIO: &[SolverConfig] = &[
+    SolverConfig { name: "minisat", flags: &[], slice_formula: true },
+    SolverConfig { name: "cadical", flags: &["--sat-solver", "cadical"], slice_formula: true },
+    SolverConfig { name: "z3", flags: &["--z3"], slice_formula: true },
+    SolverConfig { name: "minisat-no-slice", flags: &[], slice_formula: false },
+];
+
+/// How often to check whether one of the runs finished
+const POLL_INTERVAL: Duration = Duration::from_millis(20);
+
+impl KaniSession {
+    /// Run CBMC with `args` in each configuration of the portfolio at once, and keep the output of
+    /// the first run that verifies the harness, i.e., that exits with 0 or 10. The other runs are
+    /// killed as soon as it does. If none does, e.g. because a solver isn't installed or they all
+    /// run out of memory, keep the output of the first configuration.
+    ///
+    /// With `--perf-history`, only the configuration that finished first last time is run, unless
+    /// it fails to verify the harness this time.
+    ///
+    /// Like `run_redirect`, this writes the output to `output_filename`.
+    pub fn run_solver_portfolio(
+        &self,
+        args: &[OsString],
+        output_filename: &Path,
+        harness: &HarnessMetadata,
+    ) -> Result<CbmcRun> {
+        let recorded = self.recorded_perf(harness).and_then(|perf| perf.solver);
+        if let Some(order) =
+            PORTFOLIO.iter().position(|config| Some(config.name) == recorded.as_deref())
+        {
+            let run = self.race(&[order], args, output_filename)?;
+            if run.solver.is_some() || self.args.dry_run {
+                return Ok(run);
+            }
+        }
+        let all: Vec<usize> = (0..PORTFOLIO.len()).collect();
+        self.race(&all, args, output_filename)
+    }
+
+    /// Run the configurations `configs` of the portfolio at once, as described in
+    /// `run_solver_portfolio`. The run has a `solver` only if one verified the harness.
+    fn race(
+        &self,
+        configs: &[usize],
+        args: &[OsString],
+        output_filename: &Path,
+    ) -> Result<CbmcRun> {
+        // Each run is the index of its configuration, its process, its output and its peak memory.
+        let mut runs: Vec<(usize, Child, PathBuf, Option<u64>)> = Vec::new();
+        for &order in configs {
+            let config = &PORTFOLIO[order];
+            let output = crate::util::append_path(output_filename, config.name);
+            {
+                let mut temps = self.temporaries.lock().unwrap();
+                temps.push(output.clone());
+            }
+
+            // TODO get cbmc path from self
+            let mut cmd = Command::new("cbmc");
+            cmd.args(portfolio_args(config, args));
+            if self.args.verbose || self.args.dry_run {
+                println!("{} > {}", render_command(&cmd).to_string_lossy(), output.display());
+                if self.args.dry_run {
+                    continue;
+                }
+            }
+            // Solvers that fail, e.g. because they are missing, shouldn't clutter the terminal.
+            let output_file = std::fs::File::create(&output)?;
+            cmd.stdout(output_file.try_clone()?);
+            cmd.stderr(output_file);
+            cmd.stdin(Stdio::null());
+            let child = cmd
+                .spawn()
+                .context(format!("Failed to invoke {}", cmd.get_program().to_string_lossy()))?;
+            runs.push((order, child, output, None));
+        }
+        if self.args.dry_run {
+            // Short circuit, like `run_redirect`
+            let status = ExitStatus::from_raw(0);
+            return Ok(CbmcRun { status, peak_rss_kb: None, out_of_memory: false, solver: None });
+        }
+
+        let mut failed: Vec<(usize, ExitStatus, PathBuf, Option<u64>)> = Vec::new();
+        let winner = 'race: loop {
+            let mut index = 0;
+            while index < runs.len() {
+                match runs[index].1.try_wait()? {
+                    Some(status) if matches!(status.code(), Some(0 | 10)) => {
+                        let (order, _, output, peak_rss_kb) = runs.remove(index);
+                        break 'race Some((order, status, output, peak_rss_kb));
+                    }
+                    Some(status) => {
+                        let (order, _, output, peak_rss_kb) = runs.remove(index);
+                        failed.push((order, status, output, peak_rss_kb));
+                    }
+                    None => {
+                        let (_, child, _, peak_rss_kb) = &mut runs[index];
+                        *peak_rss_kb = (*peak_rss_kb).max(peak_rss(child));
+                        index += 1;
+                    }
+                }
+            }
+            if runs.is_empty() {
+                break None;
+            }
+            std::thread::sleep(POLL_INTERVAL);
+        };
+        for (_, child, ..) in &mut runs {
+            kill_run(child);
+        }
+
+        let (status, output, peak_rss_kb, solver) = match winner {
+            Some((order, status, output, peak_rss_kb)) => {
+                if self.args.verbose {
+                    println!("CBMC with {} finished first", PORTFOLIO[order].name);
+                }
+                (status, output, peak_rss_kb, Some(PORTFOLIO[order].name))
+            }
+            None => {
+                let (_, status, output, peak_rss_kb) =
+                    failed.into_iter().min_by_key(|(order, ..)| *order).unwrap();
+                (status, output, peak_rss_kb, None)
+            }
+        };
+        std::fs::rename(&output, output_filename)?;
+        Ok(CbmcRun { status, peak_rss_kb, out_of_memory: false, solver })
+    }
+}
+
+/// The arguments of CBMC for `config`, from the arguments `args` from `cbmc_flags`, which end with
+/// the goto binary and possibly `--json-ui`
+fn portfolio_args(config: &SolverConfig, args: &[OsString]) -> Vec<OsString> {
+    let mut args: Vec<OsString> = args
+        .iter()
+        .filter(|arg| config.slice_formula || arg.as_os_str() != "--slice-formula")
+        .cloned()
+        .collect();
+    let flags = config.flags.iter().map(OsString::from);
+    args.splice(0..0, flags);
+    args
+}
+
+/// Kill a run that lost the race, along with the solver it may have started (e.g. z3), which
+/// would otherwise keep running
+fn kill_run(child: &mut Child) {
+    let _ = Command::new("pkill")
+        .args(["-KILL", "-P", &child.id().to_string()])
+        .stdout(Stdio::null())
+        .stderr(Stdio::null())
+        .status();
+    let _ = child.kill();
+    let _ = child.wait();
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn check_portfolio_args() {
+        let args: Vec<OsString> =
+            ["--unwind", "2", "--slice-formula", "a.out", "--json-ui"].map(OsString::from).to_vec();
+        let config = |name| PORTFOLIO.iter().find(|config| config.name == name).unwrap();
+        assert_eq!(portfolio_args(config("minisat"), &args), args);
+        assert_eq!(
+            portfolio_args(config("cadical"), &args),
+            ["--sat-solver", "cadical", "--unwind", "2", "--slice-formula", "a.out", "--json-ui"]
+                .map(OsString::from)
+                .to_vec()
+        );
+        assert_eq!(
+            portfolio_args(config("minisat-no-slice"), &args),
+            ["--unwind", "2", "a.out", "--json-ui"].map(OsString::from).to_vec()
+        );
+    }
+}
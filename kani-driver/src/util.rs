@@ -5,6 +5,7 @@
 use std::path::Path;
 use std::path::PathBuf;
 use std::process::Command;
+use std::sync::atomic::{AtomicUsize, Ordering};
 
 /// Replace an extension with another one, in a new PathBuf. (See tests for examples)
 pub fn alter_extension(path: &Path, ext: &str) -> PathBuf {
@@ -32,6 +33,14 @@ pub fn append_path(path: &Path, ext: &str) -> PathBuf {
     str.into()
 }
 
+/// A path next to `path` to write to and then rename into place, unique to this call, so that
+/// neither concurrent Kani runs nor the threads of one ever write to the same file
+pub fn unique_tmp_path(path: &Path) -> PathBuf {
+    static NEXT: AtomicUsize = AtomicUsize::new(0);
+    let unique = format!("{}-{}", std::process::id(), NEXT.fetch_add(1, Ordering::Relaxed));
+    append_path(path, &unique)
+}
+
 /// Given a path of some sort (usually from argv0), this attempts to extract the basename / stem
 /// of the executable. e.g. "/path/foo -> foo" "./foo.exe -> foo" "foo -> foo"
 pub fn executable_basename(argv0: &Option<&OsString>) -> Option<OsString> {
@@ -57,6 +66,34 @@ pub fn join_osstring(elems: &[OsString], joiner: &str) -> OsString {
     str
 }
 
+/// A 128-bit FNV-1a hash of some contents, to key persistent caches. Unlike `DefaultHasher` and
+/// the `Hash` impls of the standard library, it gives the same result on every platform and
+/// across Rust releases.
+pub struct ContentHash(u128);
+
+impl ContentHash {
+    const OFFSET_BASIS: u128 = 0x6c62272e07bb014262b821756295c58d;
+    const PRIME: u128 = 0x0000000001000000000000000000013b;
+
+    pub fn new() -> Self {
+        ContentHash(Self::OFFSET_BASIS)
+    }
+
+    /// Add `bytes`, preceded by their length, so that consecutive updates can't run into each
+    /// other (i.e. "ab" then "c" differs from "a" then "bc").
+    pub fn update(&mut self, bytes: &[u8]) {
+        for byte in (bytes.len() as u64).to_le_bytes().iter().chain(bytes) {
+            self.0 ^= *byte as u128;
+            self.0 = self.0.wrapping_mul(Self::PRIME);
+        }
+    }
+
+    /// The hash, as the 32 hexadecimal digits used in the names of cache entries
+    pub fn finish(&self) -> String {
+        format!("{:032x}", self.0)
+    }
+}
+
 /// Render a Command as a string, to log it (e.g. in dry runs)
 pub fn render_command(cmd: &Command) -> OsString {
     let mut str = OsString::new();
@@ -120,6 +157,16 @@ fn check_append_path() {
         );
     }
 
+    #[test]
+    fn check_unique_tmp_path() {
+        let path = PathBuf::from("./file.goto");
+        let first = unique_tmp_path(&path);
+        let second = unique_tmp_path(&path);
+        assert_ne!(first, second);
+        assert_eq!(first.parent(), path.parent());
+        assert!(first.to_string_lossy().starts_with("./file.goto."));
+    }
+
     #[test]
     fn check_exe_basename() {
         assert_eq!(
@@ -145,6 +192,20 @@ fn check_join_osstring() {
         );
     }
 
+    #[test]
+    fn check_content_hash() {
+        let hash = |parts: &[&str]| {
+            let mut hash = ContentHash::new();
+            parts.iter().for_each(|part| hash.update(part.as_bytes()));
+            hash.finish()
+        };
+        // The hash must not change, since it names the entries of persistent caches.
+        assert_eq!(hash(&[]), "6c62272e07bb014262b821756295c58d");
+        assert_eq!(hash(&["ab", "c"]), hash(&["ab", "c"]));
+        assert_ne!(hash(&["ab", "c"]), hash(&["a", "bc"]));
+        assert_ne!(hash(&["ab"]), hash(&["ab", ""]));
+    }
+
     #[test]
     fn check_render_command() {
         let mut c1 = Command::new("a");
@@ -0,0 +1,73 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use anyhow::{Context, Result};
+use std::ffi::OsString;
+use std::os::unix::ffi::OsStrExt;
+use std::path::{Path, PathBuf};
+
+use crate::args::OutputFormat;
+use crate::session::KaniSession;
+use crate::util::ContentHash;
+
+/// The outcome of a CBMC run, stored as the extension of its cache entry
+const SUCCESS: &str = "success";
+const FAILURE: &str = "failure";
+
+impl KaniSession {
+    /// The entry of `--verification-cache` for verifying the goto binary `file` with the CBMC
+    /// flags `cbmc_args`, or `None` if there's no cache. The entry is keyed by everything that
+    /// determines the output of CBMC: its version and flags, and the contents of the binary. The
+    /// binary is fully specialized and instrumented, so it includes the C libraries and stubs
+    /// along with every function the harness can reach.
+    pub fn verification_cache_entry(
+        &self,
+        file: &Path,
+        cbmc_args: &[OsString],
+    ) -> Result<Option<PathBuf>> {
+        let cache_dir = match &self.args.verification_cache {
+            Some(cache_dir) if !self.args.dry_run => cache_dir.join(self.cbmc_version()?),
+            _ => return Ok(None),
+        };
+        std::fs::create_dir_all(&cache_dir)
+            .context(format!("Failed to create {}", cache_dir.display()))?;
+
+        let mut hash = ContentHash::new();
+        hash.update(&std::fs::read(file)?);
+        // The binary itself is the last argument, and its path doesn't matter.
+        for arg in cbmc_args.iter().filter(|arg| Path::new(arg) != file) {
+            hash.update(arg.as_bytes());
+        }
+        hash.update(&[(self.args.output_format == OutputFormat::Old) as u8]);
+        Ok(Some(cache_dir.join(hash.finish())))
+    }
+
+    /// Restore the output of the CBMC run stored in `entry` to `output_filename`, and return
+    /// whether CBMC succeeded, or `None` if there is no such run.
+    pub fn load_verification(&self, entry: &Path, output_filename: &Path) -> Result<Option<bool>> {
+        for (outcome, succeeded) in [(SUCCESS, true), (FAILURE, false)] {
+            let cached = entry.with_extension(outcome);
+            if cached.exists() {
+                std::fs::copy(&cached, output_filename)?;
+                return Ok(Some(succeeded));
+            }
+        }
+        Ok(None)
+    }
+
+    /// Store the output of a CBMC run in `entry`
+    pub fn store_verification(
+        &self,
+        entry: &Path,
+        output_filename: &Path,
+        succeeded: bool,
+    ) -> Result<()> {
+        let cached = entry.with_extension(if succeeded { SUCCESS } else { FAILURE });
+        // Write to a file of our own and rename it into place, so that concurrent Kani runs never
+        // observe a partially written entry.
+        let tmp = crate::util::unique_tmp_path(&cached);
+        std::fs::copy(output_filename, &tmp)?;
+        std::fs::rename(&tmp, &cached)?;
+        Ok(())
+    }
+}
@@ -16,4 +16,11 @@ pub struct HarnessMetadata {
     pub original_line: String,
     /// Optional data to store unwind value
     pub unwind_value: Option<u32>,
+    /// Optional bound on the initial capacity of the "c-ffi" Vec abstraction
+    pub vec_capacity: Option<u32>,
+    /// The goto binary of just the symbols the harness can reach, with `--slice-harnesses`
+    pub goto_file: Option<String>,
+    /// The functions without a body the harness can reach, with `--slice-harnesses`
+    #[serde(default)]
+    pub undefined_functions: Vec<String>,
 }
@@ -13,4 +13,9 @@
 #[derive(Serialize, Deserialize)]
 pub struct KaniMetadata {
     pub proof_harnesses: Vec<HarnessMetadata>,
+    /// The functions the crate calls without defining them, such as the `__rust_*` allocator
+    /// functions or the `vec_*` and `hashset_*` functions of the C stubs. The driver only links in
+    /// the C libraries that provide some of them. Older compilers did not record them.
+    #[serde(default)]
+    pub undefined_functions: Vec<String>,
 }
@@ -6,12 +6,118 @@
 #include <assert.h>
 #include <limits.h>
 #include <math.h>
+#include <setjmp.h>
+#include <signal.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+// Nondeterministic values are provided by a fast PRNG (xorshift64*), seeded by
+// the run mode below.
+static uint64_t __KANI_rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t __KANI_next_random(void)
+{
+    __KANI_rng_state ^= __KANI_rng_state >> 12;
+    __KANI_rng_state ^= __KANI_rng_state << 25;
+    __KANI_rng_state ^= __KANI_rng_state >> 27;
+    return __KANI_rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+// The generated non_det_* functions fill their result with this function.
+// Purely random bytes would almost never produce values such as a valid bool,
+// which `kani::any` then rejects with an assumption. So a quarter of the values
+// are 0 or 1 in their first byte and zero elsewhere, and another quarter are all
+// ones, to favour the boundary values that harnesses tend to care about.
+void __KANI_nondet_bytes(void *dst, size_t size)
+{
+    uint8_t *bytes = ( uint8_t * )dst;
+    uint64_t shape = __KANI_next_random();
+    if ((shape & 3) == 0) {
+        memset(bytes, 0, size);
+        if (size > 0) { bytes[ 0 ] = (shape >> 2) & 1; }
+    } else if ((shape & 3) == 1) {
+        memset(bytes, 0xff, size);
+    } else {
+        for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+            uint64_t random = __KANI_next_random();
+            size_t   chunk  = size - i < sizeof(uint64_t) ? size - i : sizeof(uint64_t);
+            memcpy(bytes + i, &random, chunk);
+        }
+    }
+}
+
+#ifndef KANI_HARNESS
 // By default, don't do anything;
 // user can add an assert if they so desire.
-void __CPROVER_assume(int condition) {}
+void __CPROVER_assume(int condition) { (void)condition; }
+#else
+// Run mode: compiling with -DKANI_HARNESS=<harness function> adds a main that
+// executes the harness repeatedly with fresh nondeterministic values.
+//
+//   ./harness [ITERATIONS [SEED]]
+//
+// Iteration i runs with seed SEED + i, so a failure can be reproduced with
+// `./harness 1 <seed of the failing iteration>`.
+//
+// An assumption that does not hold rejects the current iteration and moves on
+// to the next one. A failing assertion aborts the process after reporting the
+// iteration that failed.
+static jmp_buf            __KANI_reject;
+static bool               __KANI_running = false;
+static unsigned long long __KANI_seed    = 0;
+
+void __CPROVER_assume(int condition)
+{
+    if (!condition && __KANI_running) { longjmp(__KANI_reject, 1); }
+}
+
+static void __KANI_report_failure(int signum)
+{
+    (void)signum;
+    fprintf(stderr, "Failed with seed %llu\n", __KANI_seed);
+    _Exit(EXIT_FAILURE);
+}
+
+void KANI_HARNESS(void);
+
+// Runs one iteration of the harness, and returns false if an assumption rejected it.
+// The setjmp is kept out of main, so none of its locals live across the longjmp.
+static bool __KANI_run_iteration(void)
+{
+    if (setjmp(__KANI_reject) != 0) { return false; }
+    __KANI_running = true;
+    KANI_HARNESS();
+    __KANI_running = false;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long long iterations = argc > 1 ? strtoull(argv[ 1 ], NULL, 10) : 1000;
+    unsigned long long base_seed  = argc > 2 ? strtoull(argv[ 2 ], NULL, 10) : 1;
+
+    signal(SIGABRT, __KANI_report_failure);
+
+    unsigned long long rejected = 0;
+    for (unsigned long long i = 0; i < iterations; i++) {
+        __KANI_seed = base_seed + i;
+        // splitmix64 of the seed, so consecutive seeds give unrelated streams.
+        uint64_t z       = (__KANI_seed + 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+        __KANI_rng_state = (z ^ (z >> 31)) | 1;
+
+        if (!__KANI_run_iteration()) { rejected++; }
+    }
+
+    printf("Ran %llu iterations, %llu rejected by assumptions\n", iterations, rejected);
+    if (iterations > 0 && rejected == iterations) {
+        printf("Warning: no iteration satisfied the harness assumptions\n");
+    }
+    return EXIT_SUCCESS;
+}
+#endif
 
 // We can ignore atomics for simplicity
 void __CPROVER_atomic_begin(void) {}
@@ -34,28 +140,61 @@ typedef bool __CPROVER_bool;
 // Tracking issue: https://github.com/model-checking/kani/issues/440
 #define POINTER_OBJECT(value) 0
 
-// Use built-in overflow operators
-#define BUILTIN_ADD_OVERFLOW(var1, var2)           \
+// Use built-in overflow operators. The result is computed in `typ`, the type
+// CBMC checks the operation against, so that wide operands are not truncated.
+#define BUILTIN_ADD_OVERFLOW(typ, var1, var2)      \
     ({                                             \
-        int _tmp = 0;                              \
+        typ _tmp;                                  \
         __builtin_add_overflow(var1, var2, &_tmp); \
     })
-#define BUILTIN_SUB_OVERFLOW(var1, var2)           \
+#define BUILTIN_SUB_OVERFLOW(typ, var1, var2)      \
     ({                                             \
-        int _tmp = 0;                              \
+        typ _tmp;                                  \
         __builtin_sub_overflow(var1, var2, &_tmp); \
     })
-#define BUILTIN_MUL_OVERFLOW(var1, var2)           \
+#define BUILTIN_MUL_OVERFLOW(typ, var1, var2)      \
     ({                                             \
-        int _tmp = 0;                              \
+        typ _tmp;                                  \
         __builtin_mul_overflow(var1, var2, &_tmp); \
     })
 
-#define overflow(op, typ, var1, var2)                      \
-    ((op[ 0 ] == '+')   ? BUILTIN_ADD_OVERFLOW(var1, var2) \
-     : (op[ 0 ] == '-') ? BUILTIN_SUB_OVERFLOW(var1, var2) \
-     : (op[ 0 ] == '*') ? BUILTIN_MUL_OVERFLOW(var1, var2) \
-                        : 1)
+// `op` is always a string literal in the generated code, so `op[0]` is a
+// constant and the compiler folds the selection away: only the builtin for the
+// requested operation is emitted.
+#define overflow(op, typ, var1, var2)                             \
+    (((op)[ 0 ] == '+')   ? BUILTIN_ADD_OVERFLOW(typ, var1, var2) \
+     : ((op)[ 0 ] == '-') ? BUILTIN_SUB_OVERFLOW(typ, var1, var2) \
+     : ((op)[ 0 ] == '*') ? BUILTIN_MUL_OVERFLOW(typ, var1, var2) \
+                          : 1)
+
+// Copies `n` bytes starting at byte `offset` of the `size` byte object `src`,
+// where `offset` counts from the opposite end to the host byte order.
+// This is exact for scalars, which is what CBMC extracts bytes from.
+static inline void __KANI_copy_bytes_swapped(void *dst, size_t n, const void *src, size_t size, size_t offset)
+{
+    const uint8_t *from = ( const uint8_t * )src;
+    uint8_t       *to   = ( uint8_t * )dst;
+    for (size_t i = 0; i < n; i++) { to[ n - 1 - i ] = from[ size - 1 - (offset + i) ]; }
+}
+
+// Byte extraction in the host byte order is a plain (unaligned) load.
+#define __KANI_byte_extract_native(from_val, offset, to_type)                               \
+    ({                                                                                      \
+        typeof(to_type) __KANI_res;                                                         \
+        memcpy(&__KANI_res, ( const uint8_t * )&(from_val) + (offset), sizeof(__KANI_res)); \
+        __KANI_res;                                                                         \
+    })
+#define __KANI_byte_extract_swapped(from_val, offset, to_type)                                               \
+    ({                                                                                                       \
+        typeof(to_type) __KANI_res;                                                                          \
+        __KANI_copy_bytes_swapped(&__KANI_res, sizeof(__KANI_res), &(from_val), sizeof(from_val), (offset)); \
+        __KANI_res;                                                                                          \
+    })
 
-// Only works on little endian machines.
-#define byte_extract_little_endian(from_val, offset, to_type) *(( typeof(to_type) * )((( void * )&from_val) + (offset)))
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define byte_extract_little_endian(from_val, offset, to_type) __KANI_byte_extract_swapped(from_val, offset, to_type)
+#define byte_extract_big_endian(from_val, offset, to_type)    __KANI_byte_extract_native(from_val, offset, to_type)
+#else
+#define byte_extract_little_endian(from_val, offset, to_type) __KANI_byte_extract_native(from_val, offset, to_type)
+#define byte_extract_big_endian(from_val, offset, to_type)    __KANI_byte_extract_swapped(from_val, offset, to_type)
+#endif
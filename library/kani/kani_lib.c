@@ -19,6 +19,34 @@
 // Check that the input is either a power of 2, or 0. Algorithm from Hackers Delight.
 bool __KANI_is_nonzero_power_of_two(size_t i) { return (i != 0) && (i & (i - 1)) == 0; }
 
+// Rust's `Layout` guarantees that alignments are non-zero powers of two, so
+// the allocator functions below can only be called with an invalid alignment if
+// the model generated by Kani is wrong (or unsafe code already broke the
+// contract of `Layout::from_size_align_unchecked`). When KANI_TRUST_LAYOUT is defined (the
+// driver does so only with the unstable --trust-layout) we trust `Layout` and
+// compile these checks away, which saves a property and a constraint per call.
+#ifdef KANI_TRUST_LAYOUT
+#define __KANI_assert_layout_align(align) \
+    do {                                 \
+    } while (0)
+#else
+#define __KANI_assert_layout_align(align) \
+    __KANI_assert(__KANI_is_nonzero_power_of_two(align), "Alignment is power of two")
+#endif
+
+// CBMC represents a pointer as an object number in its upper bits (see
+// --object-bits) and an offset in the remaining bits, so the base address of
+// every object is aligned to 2 ** (64 - object-bits) bytes. This covers every
+// alignment a Rust `Layout` can request, which is at most 2 ** 29, hence there
+// is no need to over-allocate and offset the result in order to honour `align`.
+// We still assume the alignment of the returned pointer, so the guarantee the
+// caller relies on is part of the model rather than an artifact of the pointer
+// encoding. For an object base this folds to a constant during symex.
+// An invalid alignment is left to __KANI_assert_layout_align: assuming it here
+// would prune the path (e.g. an alignment of 0 only admits a null pointer).
+#define __KANI_assume_aligned(ptr, align) \
+    __CPROVER_assume(!__KANI_is_nonzero_power_of_two(align) || (( size_t )(ptr) & ((align)-1)) == 0)
+
 // This is a C implementation of the __rust_alloc function.
 // https://stdrs.dev/nightly/x86_64-unknown-linux-gnu/alloc/alloc/fn.__rust_alloc.html
 // It has the following Rust signature:
@@ -32,10 +60,10 @@ bool __KANI_is_nonzero_power_of_two(size_t i) { return (i != 0) && (i & (i - 1))
 uint8_t *__rust_alloc(size_t size, size_t align)
 {
     __KANI_assert(size > 0, "__rust_alloc must be called with a size greater than 0");
-    // TODO: Ensure we are doing the right thing with align
-    // https://github.com/model-checking/kani/issues/1168
-    __KANI_assert(__KANI_is_nonzero_power_of_two(align), "Alignment is power of two");
-    return malloc(size);
+    __KANI_assert_layout_align(align);
+    uint8_t *result = malloc(size);
+    __KANI_assume_aligned(result, align);
+    return result;
 }
 
 // This is a C implementation of the __rust_alloc_zeroed function.
@@ -51,10 +79,10 @@ uint8_t *__rust_alloc(size_t size, size_t align)
 uint8_t *__rust_alloc_zeroed(size_t size, size_t align)
 {
     __KANI_assert(size > 0, "__rust_alloc_zeroed must be called with a size greater than 0");
-    // TODO: Ensure we are doing the right thing with align
-    // https://github.com/model-checking/kani/issues/1168
-    __KANI_assert(__KANI_is_nonzero_power_of_two(align), "Alignment is power of two");
-    return calloc(1, size);
+    __KANI_assert_layout_align(align);
+    uint8_t *result = calloc(1, size);
+    __KANI_assume_aligned(result, align);
+    return result;
 }
 
 // This is a C implementation of the __rust_dealloc function.
@@ -69,9 +97,7 @@ uint8_t *__rust_alloc_zeroed(size_t size, size_t align)
 // https://doc.rust-lang.org/std/alloc/trait.GlobalAlloc.html#tymethod.dealloc
 void __rust_dealloc(uint8_t *ptr, size_t size, size_t align)
 {
-    // TODO: Ensure we are doing the right thing with align
-    // https://github.com/model-checking/kani/issues/1168
-    __KANI_assert(__KANI_is_nonzero_power_of_two(align), "Alignment is power of two");
+    __KANI_assert_layout_align(align);
 
     __KANI_assert(__CPROVER_OBJECT_SIZE(ptr) == size,
                   "rust_dealloc must be called on an object whose allocated size matches its layout");
@@ -94,11 +120,16 @@ uint8_t *__rust_realloc(uint8_t *ptr, size_t old_size, size_t align, size_t new_
     // Passing a new_size of 0 is undefined behavior
     __KANI_assert(new_size > 0, "rust_realloc must be called with a size greater than 0");
 
-    // TODO: Ensure we are doing the right thing with align
-    // https://github.com/model-checking/kani/issues/1168
-    __KANI_assert(__KANI_is_nonzero_power_of_two(align), "Alignment is power of two");
+    __KANI_assert_layout_align(align);
+
+    // The existing object already has the requested size and alignment, so we
+    // can avoid a fresh object and a copy of its contents. Note that we cannot
+    // do the same when shrinking: the object would keep its original size and we
+    // would no longer detect out-of-bounds accesses past new_size.
+    if (new_size == old_size) { return ptr; }
 
     uint8_t *result = malloc(new_size);
+    __KANI_assume_aligned(result, align);
     if (result) {
         size_t bytes_to_copy = new_size < old_size ? new_size : old_size;
         memcpy(result, ptr, bytes_to_copy);
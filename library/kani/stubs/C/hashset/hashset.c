@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 // This HashSet stub implementation is supposed to work with c_hashset.rs.
 // Please refer to that file for an introduction to the idea of a HashSet and
@@ -31,30 +32,35 @@
 // unique output for a given pair of x and y.
 //
 // Another way to think about this problem could be through the lens of
-// uninterpreted functions where : if x == y => f(x) == f(y). Exploring this can
-// be future work. The idea would be to implement a HashSet similar to that seen
-// in functional programming languages.
+// uninterpreted functions where : if x == y => f(x) == f(y). The idea would be
+// to implement a HashSet similar to that seen in functional programming
+// languages, which is what hashset_bytes at the end of this file does.
 //
-// For the purpose of a HashSet, we dont necessarily need a SENTINEL outside the
-// range of the hashing function because of the way we design the HashSet
-// operations.
-const uint16_t SENTINEL = 1;
-
+// Since we only need to record membership, the domain is a bitmap with one bit
+// per value in the output domain of the hash function. This keeps the domain
+// at 8 KiB, and every operation on it amounts to a single comparison against
+// the bit of the hashed value.
 uint16_t hasher(uint16_t value) { return value; }
 
-// We initialize all values of the domain to be 0 by initializing it with
-// calloc. This lets us get around the problem of looping through all elements
-// to initialize them individually with a special value.
-//
-// The domain array is to be interpreted such that
-// if domain[index] != 0, value such that hash(value) = index is present.
+// Number of bytes in the domain bitmap: one bit for each of the 2 ** 16 values.
+#define DOMAIN_BYTES ((( size_t )UINT16_MAX + 1) / 8)
+
+// We initialize all bits of the domain to be 0 by initializing it with calloc.
+// This lets us get around the problem of looping through all elements to
+// initialize them individually.
 //
-// However, this logic does not work for the value 0. For this, we choose the
-// SENTINEL value to initialize that element.
+// The domain bitmap is to be interpreted such that
+// if bit index of the domain is set, value such that hash(value) = index is
+// present.
 typedef struct {
-    uint16_t *domain;
+    uint8_t *domain;
 } hashset;
 
+// Returns the byte of the domain which holds the bit for hash.
+#define DOMAIN_BYTE(s, hash) ((s)->domain[ (hash) >> 3 ])
+// Returns the mask which selects the bit for hash in DOMAIN_BYTE.
+#define DOMAIN_MASK(hash) (( uint8_t )(1u << ((hash)&7)))
+
 // Ideally, this approach is much more suitable if we can work with arrays of
 // arbitrary size, specifically infinity. This would allow us to define hash
 // functions for any type because the output domain can be considered to be
@@ -75,26 +81,31 @@ typedef struct {
 //
 // Returns: pointer to a hashset instance which tracks the domain memory. This
 // pointer is used in later callbacks such as insert() and remove().
+//
+// For CBMC versions which handle unbounded arrays, --c-ffi-unbounded-arrays
+// makes the driver define KANI_UNBOUNDED_ARRAYS. The domains are then
+// zero-initialized unbounded arrays, which are never flattened, and the u32
+// HashSet below does not need its page directory.
+#ifdef KANI_UNBOUNDED_ARRAYS
+#define DOMAIN_ALLOC(bytes) (( uint8_t * )__CPROVER_allocate(__CPROVER_constant_infinity_uint, 1))
+#else
+#define DOMAIN_ALLOC(bytes) (( uint8_t * )calloc((bytes), sizeof(uint8_t)))
+#endif
+
 hashset *hashset_new()
 {
     hashset *set = ( hashset * )malloc(sizeof(hashset));
-    // Initializes value all indexes to be 0, indicating that those elements are
-    // not present in the HashSet.
-    set->domain = calloc(UINT16_MAX, sizeof(uint16_t));
-    // For 0, choose another value to achieve the same.
-    set->domain[ 0 ] = SENTINEL;
+    // Initializes all bits to be 0, indicating that those elements are not
+    // present in the HashSet.
+    set->domain = DOMAIN_ALLOC(DOMAIN_BYTES);
     return set;
 }
 
 // For insert, we need to first check if the value exists in the HashSet. If it
 // does, we immediately return a 0 (false) value back.
 //
-// If it doesnt, then we mark that element of the domain array with the value to
-// indicate that this element has been inserted. For element 0, we mark it with
-// the SENTINEL.
-//
-// To check if a value exists, we simply check if domain[hash] != 0 and
-// in the case of 0 if domain[0] != SENTINEL.
+// If it doesnt, then we set the bit of the domain to indicate that this element
+// has been inserted.
 //
 // Returns: an integer value 1 or 0. If the value is already present in the
 // hashset, this function returns a 0. If the value is sucessfully inserted, we
@@ -102,30 +113,25 @@ hashset *hashset_new()
 uint32_t hashset_insert(hashset *s, uint16_t value)
 {
     uint16_t hash = hasher(value);
+    uint8_t  mask = DOMAIN_MASK(hash);
 
-    if ((hash == 0 && s->domain[ hash ] != SENTINEL) || (hash != 0 && s->domain[ hash ] != 0)) { return 0; }
+    if (DOMAIN_BYTE(s, hash) & mask) { return 0; }
 
-    s->domain[ hash ] = value;
+    DOMAIN_BYTE(s, hash) |= mask;
     return 1;
 }
 
-// We perform a similar check here as described in hashset_insert(). We do not
-// duplicate code so as to not compute the hash twice. This can be improved.
-//
 // Returns: an integer value 1 or 0. If the value is present in the hashset,
 // this function returns a 1, otherwise 0.
 uint32_t hashset_contains(hashset *s, uint16_t value)
 {
     uint16_t hash = hasher(value);
 
-    if ((hash == 0 && s->domain[ hash ] != SENTINEL) || (hash != 0 && s->domain[ hash ] != 0)) { return 1; }
-
-    return 0;
+    return (DOMAIN_BYTE(s, hash) & DOMAIN_MASK(hash)) != 0;
 }
 
-// We check if the element exists in the array. If it does not, we return a 0
-// (false) value back. If it does, we mark it with 0 and in the case of 0, we
-// mark it with the SENTINEL and return 1.
+// We check if the element exists in the set. If it does not, we return a 0
+// (false) value back. If it does, we clear its bit and return 1.
 //
 // Returns: an integer value 1 or 0. If the value is not present in the hashset,
 // this function returns a 0. If the value is sucessfully removed from the
@@ -133,14 +139,233 @@ uint32_t hashset_contains(hashset *s, uint16_t value)
 uint32_t hashset_remove(hashset *s, uint16_t value)
 {
     uint16_t hash = hasher(value);
+    uint8_t  mask = DOMAIN_MASK(hash);
+
+    if (!(DOMAIN_BYTE(s, hash) & mask)) { return 0; }
+
+    DOMAIN_BYTE(s, hash) &= ( uint8_t )~mask;
+    return 1;
+}
+
+// hashset_u32 is the HashSet<u32> counterpart of hashset, which gets around
+// the "array too large for flattening" problem by splitting the domain in two
+// levels. The upper 16 bits of the hashed value select a page of the page
+// directory and the lower 16 bits select a bit in that page, which is a domain
+// bitmap of the same shape as the one used by hashset.
+//
+// Pages are allocated lazily the first time a value is inserted in them. As a
+// result, only the pages which are touched by the harness are materialized as
+// objects, and lookups in pages which were never allocated do not need any
+// memory at all.
+//
+// With unbounded arrays, the whole domain is a single bitmap instead.
+uint32_t hasher_u32(uint32_t value) { return value; }
+
+#ifdef KANI_UNBOUNDED_ARRAYS
+typedef struct {
+    uint8_t *domain;
+} hashset_u32;
+
+hashset_u32 *hashset_u32_new()
+{
+    hashset_u32 *set = ( hashset_u32 * )malloc(sizeof(hashset_u32));
+    set->domain      = DOMAIN_ALLOC((( size_t )UINT32_MAX + 1) / 8);
+    return set;
+}
+
+uint32_t hashset_u32_insert(hashset_u32 *s, uint32_t value)
+{
+    uint32_t hash = hasher_u32(value);
+    uint8_t  mask = DOMAIN_MASK(hash);
+
+    if (DOMAIN_BYTE(s, hash) & mask) { return 0; }
+
+    DOMAIN_BYTE(s, hash) |= mask;
+    return 1;
+}
+
+uint32_t hashset_u32_contains(hashset_u32 *s, uint32_t value)
+{
+    uint32_t hash = hasher_u32(value);
+
+    return (DOMAIN_BYTE(s, hash) & DOMAIN_MASK(hash)) != 0;
+}
+
+uint32_t hashset_u32_remove(hashset_u32 *s, uint32_t value)
+{
+    uint32_t hash = hasher_u32(value);
+    uint8_t  mask = DOMAIN_MASK(hash);
+
+    if (!(DOMAIN_BYTE(s, hash) & mask)) { return 0; }
+
+    DOMAIN_BYTE(s, hash) &= ( uint8_t )~mask;
+    return 1;
+}
+#else
+typedef struct {
+    uint8_t **pages;
+} hashset_u32;
 
-    if ((hash == 0 && s->domain[ hash ] == SENTINEL) || (hash != 0 && s->domain[ hash ] == 0)) { return 0; }
+// Number of entries in the page directory: one for each of the 2 ** 16 values of
+// the upper half of the hash.
+#define DIRECTORY_ENTRIES (( size_t )UINT16_MAX + 1)
 
-    if (hash == 0) {
-        s->domain[ hash ] = SENTINEL;
-    } else {
-        s->domain[ hash ] = 0;
+#define PAGE_INDEX(hash) ((hash) >> 16)
+#define PAGE_OFFSET(hash) (( uint16_t )((hash)&UINT16_MAX))
+
+// Returns: pointer to a hashset_u32 instance with an empty page directory.
+hashset_u32 *hashset_u32_new()
+{
+    hashset_u32 *set = ( hashset_u32 * )malloc(sizeof(hashset_u32));
+    // A NULL entry indicates that no element of that page is present.
+    set->pages = calloc(DIRECTORY_ENTRIES, sizeof(uint8_t *));
+    return set;
+}
+
+// Returns: an integer value 1 or 0. If the value is already present in the
+// hashset, this function returns a 0. If the value is sucessfully inserted, we
+// return a 1.
+uint32_t hashset_u32_insert(hashset_u32 *s, uint32_t value)
+{
+    uint32_t hash = hasher_u32(value);
+    uint8_t *page = s->pages[ PAGE_INDEX(hash) ];
+
+    if (page == NULL) {
+        page                         = DOMAIN_ALLOC(DOMAIN_BYTES);
+        s->pages[ PAGE_INDEX(hash) ] = page;
     }
 
+    uint16_t offset = PAGE_OFFSET(hash);
+    uint8_t  mask   = DOMAIN_MASK(offset);
+    if (page[ offset >> 3 ] & mask) { return 0; }
+
+    page[ offset >> 3 ] |= mask;
     return 1;
 }
+
+// Returns: an integer value 1 or 0. If the value is present in the hashset,
+// this function returns a 1, otherwise 0.
+uint32_t hashset_u32_contains(hashset_u32 *s, uint32_t value)
+{
+    uint32_t hash = hasher_u32(value);
+    uint8_t *page = s->pages[ PAGE_INDEX(hash) ];
+
+    if (page == NULL) { return 0; }
+
+    uint16_t offset = PAGE_OFFSET(hash);
+    return (page[ offset >> 3 ] & DOMAIN_MASK(offset)) != 0;
+}
+
+// Returns: an integer value 1 or 0. If the value is not present in the hashset,
+// this function returns a 0. If the value is sucessfully removed from the
+// hashset, it returns a 1.
+uint32_t hashset_u32_remove(hashset_u32 *s, uint32_t value)
+{
+    uint32_t hash = hasher_u32(value);
+    uint8_t *page = s->pages[ PAGE_INDEX(hash) ];
+
+    if (page == NULL) { return 0; }
+
+    uint16_t offset = PAGE_OFFSET(hash);
+    uint8_t  mask   = DOMAIN_MASK(offset);
+    if (!(page[ offset >> 3 ] & mask)) { return 0; }
+
+    page[ offset >> 3 ] &= ( uint8_t )~mask;
+    return 1;
+}
+#endif
+
+// hashset_bytes is a HashSet over keys of arbitrary types, which the Rust
+// frontend passes as a sequence of bytes (e.g., the fields of a tuple or the
+// contents of a String). This follows the functional view of a set mentioned
+// above: instead of hashing keys into a domain, we keep a log of the keys which
+// are present, and two keys are the same element iff their bytes are equal.
+//
+// This way, neither a hash function such as SipHash nor a domain array has to
+// be reasoned about. Every operation compares the key against the keys in the
+// log, so its cost is linear in the number of elements, which for the sets
+// built by harnesses is usually a handful.
+typedef struct {
+    uint8_t *bytes;
+    size_t   len;
+} hashset_key;
+
+typedef struct {
+    hashset_key *keys;
+    size_t       len;
+    size_t       capacity;
+} hashset_bytes;
+
+#define HASHSET_BYTES_DEFAULT_CAPACITY 16
+
+// Returns: pointer to a hashset_bytes instance with an empty log.
+hashset_bytes *hashset_bytes_new()
+{
+    hashset_bytes *set = ( hashset_bytes * )malloc(sizeof(hashset_bytes));
+    set->keys          = ( hashset_key * )malloc(HASHSET_BYTES_DEFAULT_CAPACITY * sizeof(hashset_key));
+    set->len           = 0;
+    set->capacity      = HASHSET_BYTES_DEFAULT_CAPACITY;
+    return set;
+}
+
+// Returns: the index of the key in the log, or s->len if it is not present.
+size_t hashset_bytes_find(hashset_bytes *s, const uint8_t *key, size_t len)
+{
+    for (size_t i = 0; i < s->len; i++) {
+        if (s->keys[ i ].len == len && memcmp(s->keys[ i ].bytes, key, len) == 0) { return i; }
+    }
+    return s->len;
+}
+
+// Returns: an integer value 1 or 0. If the key is already present in the
+// hashset, this function returns a 0. If the key is sucessfully inserted, we
+// return a 1. The key bytes are copied, so the caller keeps ownership of key.
+uint32_t hashset_bytes_insert(hashset_bytes *s, const uint8_t *key, size_t len)
+{
+    if (hashset_bytes_find(s, key, len) != s->len) { return 0; }
+
+    if (s->len == s->capacity) {
+        s->capacity = s->capacity * 2;
+        s->keys     = ( hashset_key * )realloc(s->keys, s->capacity * sizeof(hashset_key));
+    }
+
+    uint8_t *bytes = ( uint8_t * )malloc(len);
+    memcpy(bytes, key, len);
+    s->keys[ s->len ].bytes = bytes;
+    s->keys[ s->len ].len   = len;
+    s->len += 1;
+    return 1;
+}
+
+// Returns: an integer value 1 or 0. If the key is present in the hashset,
+// this function returns a 1, otherwise 0.
+uint32_t hashset_bytes_contains(hashset_bytes *s, const uint8_t *key, size_t len)
+{
+    return hashset_bytes_find(s, key, len) != s->len;
+}
+
+// The order of the log does not matter, so the last key takes the place of the
+// removed one.
+//
+// Returns: an integer value 1 or 0. If the key is not present in the hashset,
+// this function returns a 0. If the key is sucessfully removed from the
+// hashset, it returns a 1.
+uint32_t hashset_bytes_remove(hashset_bytes *s, const uint8_t *key, size_t len)
+{
+    size_t index = hashset_bytes_find(s, key, len);
+    if (index == s->len) { return 0; }
+
+    free(s->keys[ index ].bytes);
+    s->len -= 1;
+    s->keys[ index ] = s->keys[ s->len ];
+    return 1;
+}
+
+size_t hashset_bytes_len(hashset_bytes *s) { return s->len; }
+
+void hashset_bytes_free(hashset_bytes *s)
+{
+    for (size_t i = 0; i < s->len; i++) { free(s->keys[ i ].bytes); }
+    free(s->keys);
+    free(s);
+}
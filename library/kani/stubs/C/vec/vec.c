@@ -32,11 +32,7 @@
 // of words. The current implementation works only if the containing type is
 // u32. This was specifically chosen due to a use case seen in the Firecracker
 // codebase. This structure is used to communicate over the FFI boundary.
-// Future work:
-// Ideally, the pointer to memory would be uint8_t* - representing that we treat
-// memory as an array of bytes. This would allow us to be generic over the type
-// of the element contained in the Vector. In that case, we would have to treat
-// every sizeof(T) bytes as an indivdual element and cast memory accordingly.
+// For Vectors over arbitrary element types, please refer to vec_bytes below.
 typedef struct {
     uint32_t *mem;
     size_t    len;
@@ -77,9 +73,97 @@ typedef struct {
 // copying over elements, we can track only the end pointer of the memory and
 // shift it to track the new length. Since this behavior is that of the
 // allocator, the consumer of the API is blind to it.
+//
+// We implement the latter in this file as the "end-pointer" growth mode, which
+// is enabled by defining KANI_VEC_END_POINTER (the driver does so for
+// --abs-type c-ffi). In this mode, every Vector allocates a single backing
+// object of at least KANI_VEC_BACKING_BYTES bytes up front and growing the
+// Vector only moves its capacity within that object. We fall back to realloc
+// only if the requested capacity does not fit in the backing object, which for
+// harnesses with concrete bounds is pruned away during symbolic execution.
+//
+// Finally, defining KANI_UNBOUNDED_ARRAYS implements the unbounded array idea
+// above for CBMC versions which translate __CPROVER_constant_infinity_uint
+// correctly (the driver defines it with --c-ffi-unbounded-arrays). Every
+// Vector is then backed by an unbounded array, so growing it never copies and
+// its size is not limited by array flattening. This mode takes precedence over
+// the end-pointer one.
+//
+// All of the above size a new Vector with DEFAULT_CAPACITY, so a harness only
+// ever sees one capacity state and overflows past the capacity go unnoticed.
+// Defining KANI_VEC_SYMBOLIC_CAPACITY (see --c-ffi-symbolic-capacity) instead
+// gives every new Vector a nondeterministic capacity, bounded by the
+// #[kani::vec_capacity] attribute of the harness, and allocates exactly that
+// capacity as a single object. One proof then covers every capacity up to the
+// bound, including the growth paths, with small objects for the solver. This
+// mode takes precedence over the other ones.
+#ifdef KANI_VEC_SYMBOLIC_CAPACITY
+// The driver defines this for each harness, from its #[kani::vec_capacity]
+// attribute.
+extern size_t __KANI_vec_max_capacity;
+#endif
+
+#ifdef KANI_VEC_END_POINTER
+#ifndef KANI_VEC_BACKING_BYTES
+#define KANI_VEC_BACKING_BYTES (DEFAULT_CAPACITY * 64)
+#endif
+#endif
+
+// Returns the capacity of a new Vector which must hold at least min_cap
+// elements. Outside of symbolic-capacity mode, this is default_cap.
+size_t vec_initial_capacity(size_t min_cap, size_t default_cap)
+{
+#ifdef KANI_VEC_SYMBOLIC_CAPACITY
+    (void)default_cap;
+    size_t bound = min_cap > __KANI_vec_max_capacity ? min_cap : __KANI_vec_max_capacity;
+    // Uninitialized locals are nondeterministic for CBMC.
+    size_t capacity;
+    __CPROVER_assume(capacity >= min_cap && capacity <= bound);
+    return capacity;
+#else
+    (void)min_cap;
+    return default_cap;
+#endif
+}
+
+// Allocates memory for capacity elements of elem_size bytes. In end-pointer
+// mode the allocation is extended to the backing size, and with unbounded
+// arrays it has no bound at all.
+void *vec_alloc(size_t capacity, size_t elem_size)
+{
+#if defined(KANI_VEC_SYMBOLIC_CAPACITY)
+    return malloc(capacity * elem_size);
+#elif defined(KANI_UNBOUNDED_ARRAYS)
+    return malloc(__CPROVER_constant_infinity_uint);
+#else
+    size_t bytes = capacity * elem_size;
+#ifdef KANI_VEC_END_POINTER
+    if (bytes < KANI_VEC_BACKING_BYTES) { bytes = KANI_VEC_BACKING_BYTES; }
+#endif
+    return malloc(bytes);
+#endif
+}
+
+// Returns memory which can hold new_cap elements of elem_size bytes and
+// contains the elements of mem. In end-pointer mode, this is mem itself as long
+// as the backing object is large enough, and with unbounded arrays it always is.
+void *vec_realloc(void *mem, size_t new_cap, size_t elem_size)
+{
+#if defined(KANI_VEC_SYMBOLIC_CAPACITY)
+    return realloc(mem, new_cap * elem_size);
+#elif defined(KANI_UNBOUNDED_ARRAYS)
+    return mem;
+#else
+#ifdef KANI_VEC_END_POINTER
+    if (new_cap <= __CPROVER_OBJECT_SIZE(mem) / elem_size) { return mem; }
+#endif
+    return realloc(mem, new_cap * elem_size);
+#endif
+}
+
 void vec_grow_exact(vec *v, size_t new_cap)
 {
-    uint32_t *new_mem = ( uint32_t * )realloc(v->mem, new_cap * sizeof(*v->mem));
+    uint32_t *new_mem = ( uint32_t * )vec_realloc(v->mem, new_cap, sizeof(*v->mem));
 
     v->mem      = new_mem;
     v->capacity = new_cap;
@@ -121,8 +205,8 @@ vec *vec_new()
     vec *v = ( vec * )malloc(sizeof(vec));
     // Default size is DEFAULT_CAPACITY. We compute the maximum number of
     // elements to ensure that allocation size is aligned.
-    size_t max_elements = DEFAULT_CAPACITY / sizeof(*v->mem);
-    v->mem              = ( uint32_t * )malloc(max_elements * sizeof(*v->mem));
+    size_t max_elements = vec_initial_capacity(0, DEFAULT_CAPACITY / sizeof(*v->mem));
+    v->mem              = ( uint32_t * )vec_alloc(max_elements, sizeof(*v->mem));
     v->len              = 0;
     v->capacity         = max_elements;
     // Return a pointer to the allocated vec structure, which is used in future
@@ -139,7 +223,8 @@ vec *vec_with_capacity(size_t capacity)
         assert(0);
     }
 
-    v->mem      = ( uint32_t * )malloc(capacity * sizeof(*v->mem));
+    capacity    = vec_initial_capacity(capacity, capacity);
+    v->mem      = ( uint32_t * )vec_alloc(capacity, sizeof(*v->mem));
     v->len      = 0;
     v->capacity = capacity;
     return v;
@@ -166,14 +251,28 @@ uint32_t vec_pop(vec *v)
     return v->mem[ v->len ];
 }
 
+// Ensures that the Vector can hold at least additional more elements. Unlike
+// vec_sized_grow, the Vector is only resized if its capacity does not suffice.
+void vec_reserve(vec *v, size_t additional)
+{
+    if (v->capacity - v->len < additional) { vec_sized_grow(v, additional); }
+}
+
+// Appends count elements starting at elems. The Vector grows at most once and
+// the elements are copied with a single memcpy, which is a single array
+// constraint for the solver instead of one per pushed element.
+void vec_extend_from_slice(vec *v, const uint32_t *elems, size_t count)
+{
+    vec_reserve(v, count);
+    memcpy(v->mem + v->len, elems, count * sizeof(*v->mem));
+    v->len = v->len + count;
+}
+
+// Moves all elements of v2 to the end of v1, leaving v2 empty.
 void vec_append(vec *v1, vec *v2)
 {
-    // Reserve enough space before adding in new elements.
-    vec_sized_grow(v1, v2->len);
-    // Perform a memcpy of elements which is cheaper than pushing each element
-    // at once.
-    memcpy(v1->mem + v1->len, v2->mem, v2->len * sizeof(*v2->mem));
-    v1->len = v1->len + v2->len;
+    vec_extend_from_slice(v1, v2->mem, v2->len);
+    v2->len = 0;
 }
 
 size_t vec_len(vec *v) { return v->len; }
@@ -185,3 +284,124 @@ void vec_free(vec *v)
     free(v->mem);
     free(v);
 }
+
+// vec_bytes is the byte-addressed counterpart of vec, which lets the
+// abstraction be generic over the type of the element contained in the Vector.
+// Memory is tracked as an array of bytes and every elem_size bytes are treated
+// as an individual element. The Rust frontend passes elem_size = sizeof(T) and
+// elements are moved across the FFI boundary with memcpy, which means that we
+// do not need to cast memory to the element type and do not depend on the
+// alignment of the allocation.
+//
+// Zero-sized element types are not supported, since an element would not
+// occupy any memory in the allocation.
+typedef struct {
+    uint8_t *mem;
+    size_t   len;
+    size_t   capacity;
+    size_t   elem_size;
+} vec_bytes;
+
+void vec_bytes_grow_exact(vec_bytes *v, size_t new_cap)
+{
+    if (new_cap > MAX_MALLOC_SIZE / v->elem_size) {
+        // Panic if the new size requirement is greater than max size that can
+        // be allocated through malloc.
+        assert(0);
+    }
+
+    uint8_t *new_mem = ( uint8_t * )vec_realloc(v->mem, new_cap, v->elem_size);
+
+    v->mem      = new_mem;
+    v->capacity = new_cap;
+}
+
+// Same growth policy as vec_sized_grow, in terms of elements rather than bytes.
+void vec_bytes_sized_grow(vec_bytes *v, size_t additional)
+{
+    size_t min_cap  = v->capacity + additional;
+    size_t grow_cap = v->capacity * 2;
+    size_t new_cap  = min_cap > grow_cap ? min_cap : grow_cap;
+
+    vec_bytes_grow_exact(v, new_cap);
+}
+
+vec_bytes *vec_bytes_new(size_t elem_size)
+{
+    assert(elem_size > 0);
+    vec_bytes *v = ( vec_bytes * )malloc(sizeof(vec_bytes));
+    // Similar to vec_new, we preallocate DEFAULT_CAPACITY bytes and compute
+    // the maximum number of elements which fit in them.
+    size_t max_elements = vec_initial_capacity(0, DEFAULT_CAPACITY / elem_size);
+    v->mem              = ( uint8_t * )vec_alloc(max_elements, elem_size);
+    v->len              = 0;
+    v->capacity         = max_elements;
+    v->elem_size        = elem_size;
+    return v;
+}
+
+vec_bytes *vec_bytes_with_capacity(size_t elem_size, size_t capacity)
+{
+    assert(elem_size > 0);
+    vec_bytes *v = ( vec_bytes * )malloc(sizeof(vec_bytes));
+    if (capacity > MAX_MALLOC_SIZE / elem_size) {
+        // Panic if the new size requirement is greater than max size that can
+        // be allocated through malloc.
+        assert(0);
+    }
+
+    capacity     = vec_initial_capacity(capacity, capacity);
+    v->mem       = ( uint8_t * )vec_alloc(capacity, elem_size);
+    v->len       = 0;
+    v->capacity  = capacity;
+    v->elem_size = elem_size;
+    return v;
+}
+
+// Copies elem_size bytes starting at elem into the slot after the last element
+// of the Vector.
+void vec_push_bytes(vec_bytes *v, const uint8_t *elem)
+{
+    if (v->len == v->capacity) { vec_bytes_sized_grow(v, 1); }
+
+    memcpy(v->mem + v->len * v->elem_size, elem, v->elem_size);
+    v->len += 1;
+}
+
+// Copies the last element of the Vector into out, which must point to at least
+// elem_size bytes.
+void vec_pop_bytes(vec_bytes *v, uint8_t *out)
+{
+    assert(v->len > 0);
+    v->len -= 1;
+
+    memcpy(out, v->mem + v->len * v->elem_size, v->elem_size);
+}
+
+// Same as vec_reserve, in terms of elements of elem_size bytes.
+void vec_bytes_reserve(vec_bytes *v, size_t additional)
+{
+    if (v->capacity - v->len < additional) { vec_bytes_sized_grow(v, additional); }
+}
+
+// Moves all elements of v2 to the end of v1, leaving v2 empty. Resetting the
+// length of v2 also matters for memory safety here, because the Rust frontend
+// drops the elements which are still tracked by a Vector.
+void vec_append_bytes(vec_bytes *v1, vec_bytes *v2)
+{
+    assert(v1->elem_size == v2->elem_size);
+    vec_bytes_reserve(v1, v2->len);
+    memcpy(v1->mem + v1->len * v1->elem_size, v2->mem, v2->len * v2->elem_size);
+    v1->len = v1->len + v2->len;
+    v2->len = 0;
+}
+
+size_t vec_bytes_len(vec_bytes *v) { return v->len; }
+
+size_t vec_bytes_cap(vec_bytes *v) { return v->capacity; }
+
+void vec_bytes_free(vec_bytes *v)
+{
+    free(v->mem);
+    free(v);
+}
@@ -1,6 +1,12 @@
 // Copyright Kani Contributors
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
+#[path = "../vec/utils.rs"]
+mod utils;
+use utils::libc::{int16_t, size_t, uint16_t, uint32_t, uint8_t};
+
+use std::marker::PhantomData;
+
 // NOTE: Code in this file and hashset.c is experimental and is meant to be a
 // proof-of-concept implementation of the idea. It is unsound and might not work
 // with all test cases. More details below.
@@ -96,3 +102,231 @@ pub fn remove(&mut self, value: uint16_t) -> bool {
         unsafe { hashset_remove(self.ptr, value) != 0 }
     }
 }
+
+// c_hashset_u32 is the HashSet<u32> counterpart of c_hashset. It consists of a
+// pointer to the page directory of the two-level domain implemented in
+// hashset.c, where pages are only allocated when they are first inserted into.
+// When hashset.c is built with unbounded arrays, it points to the flat domain
+// instead. The FFI layout is a single pointer either way.
+#[repr(C)]
+pub struct c_hashset_u32 {
+    pages: *mut *mut uint8_t,
+}
+
+// These functions call into the u32 implementations defined in hashset.c.
+extern "C" {
+    // Returns a pointer to a new c_hashset_u32 structure.
+    fn hashset_u32_new() -> *mut c_hashset_u32;
+
+    // Inserts a new value in the hashset. If the value is already present,
+    // this function returns 0 else, returns 1.
+    fn hashset_u32_insert(ptr: *mut c_hashset_u32, value: uint32_t) -> uint32_t;
+
+    // Checks if the value is contained in the hashset. Returns 1 if present, 0
+    // otherwise.
+    fn hashset_u32_contains(ptr: *mut c_hashset_u32, value: uint32_t) -> uint32_t;
+
+    // Removes a value from the hashset. If the value is not present, it returns 0
+    // else 1.
+    fn hashset_u32_remove(ptr: *mut c_hashset_u32, value: uint32_t) -> uint32_t;
+}
+
+// HashSetU32 exposes the same interface as HashSet for u32 values.
+pub struct HashSetU32<T> {
+    ptr: *mut c_hashset_u32,
+    _marker: PhantomData<T>,
+}
+
+impl<T> HashSetU32<T> {
+    pub fn new() -> Self {
+        unsafe { HashSetU32 { ptr: hashset_u32_new(), _marker: Default::default() } }
+    }
+
+    pub fn insert(&mut self, value: uint32_t) -> bool {
+        unsafe { hashset_u32_insert(self.ptr, value) != 0 }
+    }
+
+    pub fn contains(&self, value: &uint32_t) -> bool {
+        unsafe { hashset_u32_contains(self.ptr, *value) != 0 }
+    }
+
+    pub fn remove(&mut self, value: uint32_t) -> bool {
+        unsafe { hashset_u32_remove(self.ptr, value) != 0 }
+    }
+}
+
+// c_hashset_bytes is the HashSet counterpart for keys of arbitrary types. The C
+// backend keeps a log of the bytes of the keys which are present, please refer
+// to hashset.c for the details.
+#[repr(C)]
+pub struct c_hashset_bytes {
+    keys: *mut uint8_t,
+    len: size_t,
+    capacity: size_t,
+}
+
+// These functions call into the byte-key implementations defined in hashset.c.
+// Keys are passed as a pointer to their bytes and the number of bytes.
+extern "C" {
+    // Returns a pointer to a new c_hashset_bytes structure.
+    fn hashset_bytes_new() -> *mut c_hashset_bytes;
+
+    // Inserts a copy of the key in the hashset. If the key is already present,
+    // this function returns 0 else, returns 1.
+    fn hashset_bytes_insert(
+        ptr: *mut c_hashset_bytes,
+        key: *const uint8_t,
+        len: size_t,
+    ) -> uint32_t;
+
+    // Checks if the key is contained in the hashset. Returns 1 if present, 0
+    // otherwise.
+    fn hashset_bytes_contains(
+        ptr: *mut c_hashset_bytes,
+        key: *const uint8_t,
+        len: size_t,
+    ) -> uint32_t;
+
+    // Removes a key from the hashset. If the key is not present, it returns 0
+    // else 1.
+    fn hashset_bytes_remove(
+        ptr: *mut c_hashset_bytes,
+        key: *const uint8_t,
+        len: size_t,
+    ) -> uint32_t;
+
+    // Returns the number of keys in the hashset.
+    fn hashset_bytes_len(ptr: *mut c_hashset_bytes) -> size_t;
+
+    // Free the memory allocated for the hashset and its keys.
+    fn hashset_bytes_free(ptr: *mut c_hashset_bytes);
+}
+
+// Types which can be stored in a BytesHashSet. Two values must be equal iff
+// their key bytes are equal, which is why we do not use the in-memory
+// representation of the value: it may contain padding or pointers.
+pub trait HashSetKey {
+    fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R;
+}
+
+macro_rules! int_hashset_key {
+    ($($t:ty),*) => {
+        $(
+            impl HashSetKey for $t {
+                fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+                    f(&self.to_ne_bytes())
+                }
+            }
+        )*
+    };
+}
+
+int_hashset_key!(u8, u16, u32, u64, u128, usize, i8, i16, i32, i64, i128, isize);
+
+impl HashSetKey for bool {
+    fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+        f(&[*self as u8])
+    }
+}
+
+impl HashSetKey for char {
+    fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+        (*self as u32).with_key_bytes(f)
+    }
+}
+
+impl HashSetKey for str {
+    fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+        f(self.as_bytes())
+    }
+}
+
+impl HashSetKey for String {
+    fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+        f(self.as_bytes())
+    }
+}
+
+impl<T: HashSetKey + ?Sized> HashSetKey for &T {
+    fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+        (**self).with_key_bytes(f)
+    }
+}
+
+// Tuple keys of up to this many bytes are built in an array on the stack. A
+// Vec would cost an allocation and a copy loop in the model on every operation.
+const TUPLE_KEY_BYTES: usize = 64;
+
+// The bytes of the first element are prefixed with their length, so that
+// ("ab", "c") and ("a", "bc") have different keys.
+impl<A: HashSetKey, B: HashSetKey> HashSetKey for (A, B) {
+    fn with_key_bytes<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+        self.0.with_key_bytes(|a| {
+            self.1.with_key_bytes(|b| {
+                let prefix = a.len().to_ne_bytes();
+                let (a_start, b_start) = (prefix.len(), prefix.len() + a.len());
+                let len = b_start + b.len();
+                if len > TUPLE_KEY_BYTES {
+                    // Only long keys, e.g. of Strings, are built on the heap.
+                    let mut key = std::vec::Vec::with_capacity(len);
+                    key.extend_from_slice(&prefix);
+                    key.extend_from_slice(a);
+                    key.extend_from_slice(b);
+                    return f(&key);
+                }
+                let mut key = [0u8; TUPLE_KEY_BYTES];
+                key[..a_start].copy_from_slice(&prefix);
+                key[a_start..b_start].copy_from_slice(a);
+                key[b_start..len].copy_from_slice(b);
+                f(&key[..len])
+            })
+        })
+    }
+}
+
+// BytesHashSet exposes the same interface as HashSet, but is generic over the
+// type of its elements, which are stored by their key bytes.
+pub struct BytesHashSet<T: HashSetKey> {
+    ptr: *mut c_hashset_bytes,
+    _marker: PhantomData<T>,
+}
+
+impl<T: HashSetKey> BytesHashSet<T> {
+    pub fn new() -> Self {
+        unsafe { BytesHashSet { ptr: hashset_bytes_new(), _marker: Default::default() } }
+    }
+
+    pub fn insert(&mut self, value: T) -> bool {
+        value.with_key_bytes(|key| unsafe {
+            hashset_bytes_insert(self.ptr, key.as_ptr(), key.len()) != 0
+        })
+    }
+
+    pub fn contains(&self, value: &T) -> bool {
+        value.with_key_bytes(|key| unsafe {
+            hashset_bytes_contains(self.ptr, key.as_ptr(), key.len()) != 0
+        })
+    }
+
+    pub fn remove(&mut self, value: &T) -> bool {
+        value.with_key_bytes(|key| unsafe {
+            hashset_bytes_remove(self.ptr, key.as_ptr(), key.len()) != 0
+        })
+    }
+
+    pub fn len(&self) -> usize {
+        unsafe { hashset_bytes_len(self.ptr) }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+impl<T: HashSetKey> Drop for BytesHashSet<T> {
+    fn drop(&mut self) {
+        unsafe {
+            hashset_bytes_free(self.ptr);
+        }
+    }
+}
@@ -2,9 +2,11 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
 mod utils;
-use utils::libc::{int16_t, size_t, uint16_t, uint32_t};
+use utils::libc::{int16_t, size_t, uint16_t, uint32_t, uint8_t};
 
 use std::marker::PhantomData;
+use std::mem::{self, MaybeUninit};
+use std::ptr;
 
 // CVec is an abstraction of the Vector library which is implemented as a Rust-based
 // frontend and a C based backend. All public facing methods here are implemented
@@ -75,9 +77,17 @@ pub struct c_vec {
     // Returns the length of the Vector
     fn vec_len(ptr: *mut c_vec) -> size_t;
 
-    // Append Vector represented by ptr2 to ptr1.
+    // Append Vector represented by ptr2 to ptr1, leaving ptr2 empty.
     fn vec_append(ptr1: *mut c_vec, ptr2: *mut c_vec);
 
+    // Append count elements starting at elems to the Vector, growing it at most
+    // once and copying the elements with a single memcpy.
+    fn vec_extend_from_slice(ptr: *mut c_vec, elems: *const uint32_t, count: size_t);
+
+    // Ensure that the Vector can hold atleast additional more elements. The
+    // Vector is only resized if its capacity does not suffice.
+    fn vec_reserve(ptr: *mut c_vec, additional: size_t);
+
     // Grow the allocated vector in size such that it accomodates atleast
     // additional elements. This is similar in behavior to the implementation of
     // the Rust Standard Library. Please refer to vec.c for more details.
@@ -141,11 +151,43 @@ pub fn len(&self) -> usize {
 
     pub fn reserve(&mut self, additional: usize) {
         unsafe {
-            vec_sized_grow(self.ptr, additional);
+            vec_reserve(self.ptr, additional);
+        }
+    }
+
+    pub fn extend_from_slice(&mut self, other: &[uint32_t]) {
+        unsafe {
+            vec_extend_from_slice(self.ptr, other.as_ptr(), other.len());
+        }
+    }
+}
+
+// Elements of an arbitrary iterator cannot be copied in bulk, but we reserve
+// space for them up front so that pushing them does not grow the Vector again.
+impl<T> Extend<uint32_t> for Vec<T> {
+    fn extend<I: IntoIterator<Item = uint32_t>>(&mut self, iter: I) {
+        let iter = iter.into_iter();
+        self.reserve(iter.size_hint().0);
+        for elem in iter {
+            self.push(elem);
         }
     }
 }
 
+impl<'a, T> Extend<&'a uint32_t> for Vec<T> {
+    fn extend<I: IntoIterator<Item = &'a uint32_t>>(&mut self, iter: I) {
+        self.extend(iter.into_iter().copied());
+    }
+}
+
+impl<T> From<&[uint32_t]> for Vec<T> {
+    fn from(slice: &[uint32_t]) -> Self {
+        let mut v = Vec::with_capacity(slice.len());
+        v.extend_from_slice(slice);
+        v
+    }
+}
+
 impl<T> Drop for Vec<T> {
     // We have implemented Vec for u32 which does not have any drop semantics
     // associated with it. We are only responsible for deallocating the space
@@ -161,6 +203,141 @@ fn drop(&mut self) {
     }
 }
 
+// c_vec_bytes is the generic counterpart of c_vec. Memory is tracked as an array
+// of bytes and the C backend treats every elem_size bytes as an individual
+// element. This structure mirrors vec_bytes in vec.c.
+#[repr(C)]
+pub struct c_vec_bytes {
+    mem: *mut uint8_t,
+    len: size_t,
+    capacity: size_t,
+    elem_size: size_t,
+}
+
+// These functions call into the byte-addressed implementations defined in
+// vec.c. Elements are passed as pointers to elem_size bytes and are copied
+// in and out of the Vector memory with memcpy.
+extern "C" {
+    // Returns pointer to a new c_vec_bytes structure which holds elements of
+    // elem_size bytes. The default capacity of the allocated vec is
+    // (1024 / elem_size) elements.
+    fn vec_bytes_new(elem_size: size_t) -> *mut c_vec_bytes;
+
+    // Returns pointer to a new c_vec_bytes structure with room for cap elements.
+    fn vec_bytes_with_capacity(elem_size: size_t, cap: size_t) -> *mut c_vec_bytes;
+
+    // Copies elem_size bytes from elem to the end of the Vector, resizing it
+    // if there is not enough space.
+    fn vec_push_bytes(ptr: *mut c_vec_bytes, elem: *const uint8_t);
+
+    // Copies the last element of the Vector into out and removes it.
+    fn vec_pop_bytes(ptr: *mut c_vec_bytes, out: *mut uint8_t);
+
+    // Returns the current capacity of allocation in elements.
+    fn vec_bytes_cap(ptr: *mut c_vec_bytes) -> size_t;
+
+    // Returns the length of the Vector in elements.
+    fn vec_bytes_len(ptr: *mut c_vec_bytes) -> size_t;
+
+    // Move all elements of ptr2 to the end of ptr1, leaving ptr2 empty.
+    fn vec_append_bytes(ptr1: *mut c_vec_bytes, ptr2: *mut c_vec_bytes);
+
+    // Grow the allocated vector such that it accomodates atleast additional
+    // elements.
+    fn vec_bytes_sized_grow(ptr: *mut c_vec_bytes, additional: size_t);
+
+    // Ensure that the Vector can hold atleast additional more elements, only
+    // resizing it if its capacity does not suffice.
+    fn vec_bytes_reserve(ptr: *mut c_vec_bytes, additional: size_t);
+
+    // Free allocated memory for the Vec
+    fn vec_bytes_free(ptr: *mut c_vec_bytes);
+}
+
+// BytesVec is a Vector which is generic over the contained type. It exposes the
+// same interface as Vec above, but elements are moved over the FFI boundary as
+// size_of::<T>() bytes. Elements that are pushed are owned by the C backend
+// until they are popped or the Vector is dropped.
+//
+// Zero-sized types are not supported by the C backend.
+pub struct BytesVec<T> {
+    ptr: *mut c_vec_bytes,
+    _marker: PhantomData<T>,
+}
+
+impl<T> BytesVec<T> {
+    pub fn ptr(&mut self) -> *mut c_vec_bytes {
+        return self.ptr;
+    }
+
+    pub fn new() -> Self {
+        unsafe { BytesVec { ptr: vec_bytes_new(mem::size_of::<T>()), _marker: Default::default() } }
+    }
+
+    pub fn with_capacity(cap: usize) -> Self {
+        unsafe {
+            BytesVec {
+                ptr: vec_bytes_with_capacity(mem::size_of::<T>(), cap),
+                _marker: Default::default(),
+            }
+        }
+    }
+
+    // The bytes of elem are copied into the Vector memory, so we forget elem
+    // to make sure it is not dropped twice.
+    pub fn push(&mut self, elem: T) {
+        unsafe {
+            vec_push_bytes(self.ptr, &elem as *const T as *const uint8_t);
+        }
+        mem::forget(elem);
+    }
+
+    pub fn pop(&mut self) -> Option<T> {
+        if self.len() == 0 {
+            None
+        } else {
+            let mut out = MaybeUninit::<T>::uninit();
+            unsafe {
+                vec_pop_bytes(self.ptr, out.as_mut_ptr() as *mut uint8_t);
+                Some(out.assume_init())
+            }
+        }
+    }
+
+    pub fn append(&mut self, other: &mut Self) {
+        unsafe {
+            vec_append_bytes(self.ptr, other.ptr());
+        }
+    }
+
+    pub fn capacity(&self) -> usize {
+        unsafe { vec_bytes_cap(self.ptr) as usize }
+    }
+
+    pub fn len(&self) -> usize {
+        unsafe { vec_bytes_len(self.ptr) as usize }
+    }
+
+    pub fn reserve(&mut self, additional: usize) {
+        unsafe {
+            vec_bytes_reserve(self.ptr, additional);
+        }
+    }
+}
+
+impl<T> Drop for BytesVec<T> {
+    // Unlike Vec, the contained type may have drop semantics, so we drop every
+    // element still tracked by the Vector before deallocating the C backend
+    // memory.
+    fn drop(&mut self) {
+        unsafe {
+            let mem = (*self.ptr).mem as *mut T;
+            ptr::drop_in_place(ptr::slice_from_raw_parts_mut(mem, self.len()));
+            vec_bytes_free(self.ptr);
+        }
+    }
+}
+
 // Here, we define the kani_vec! macro which behaves similar to the vec! macro
 // found in the std prelude. If we try to override the vec! macro, we get error:
 //
@@ -1,6 +1,9 @@
 // Copyright Kani Contributors
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
+mod utils;
+use utils::__nondet;
+
 use std::marker::PhantomData;
 use std::mem;
 
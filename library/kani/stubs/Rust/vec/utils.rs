@@ -10,8 +10,12 @@
 pub extern crate libc;
 
 // Currently, the way we handle non-determinism is to implement a __nondet::<T>::()
-// function which is stubbed to be `unimplemented!()`. However, at a later time
+// function which returns an unconstrained value, with `kani::any_raw`. However, at a later time
 // it could be possible to implement a Nondet<T> trait per type. This would with
 // enum types such as Option where we could decide whether we want to return
 // a None or a Some(Nondet<T>). That method would likely end up in this file so
 // that it can be used throughout.
+#[allow(dead_code)]
+pub fn __nondet<T>() -> T {
+    unsafe { kani::any_raw::<T>() }
+}
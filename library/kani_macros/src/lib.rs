@@ -73,3 +73,27 @@ pub fn unwind(attr: TokenStream, item: TokenStream) -> TokenStream {
     result.extend(item);
     result
 }
+
+#[cfg(not(kani))]
+#[proc_macro_attribute]
+pub fn vec_capacity(_attr: TokenStream, item: TokenStream) -> TokenStream {
+    // When the config is not kani, we should leave the function alone
+    item
+}
+
+/// Bound the nondeterministic initial capacity of the "c-ffi" Vec abstraction for a proof harness
+/// verified with `--c-ffi-symbolic-capacity`.
+/// The attribute '#[kani::vec_capacity(arg)]' can only be called alongside '#[kani::proof]'.
+/// arg - Takes in a integer value (u32) that represents the largest initial capacity.
+#[cfg(kani)]
+#[proc_macro_attribute]
+pub fn vec_capacity(attr: TokenStream, item: TokenStream) -> TokenStream {
+    let mut result = TokenStream::new();
+
+    // Translate #[kani::vec_capacity(arg)] to #[kanitool::vec_capacity(arg)]
+    let insert_string = "#[kanitool::vec_capacity(".to_owned() + &attr.to_string() + ")]";
+    result.extend(insert_string.parse::<TokenStream>().unwrap());
+
+    result.extend(item);
+    result
+}
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+# Copyright Kani Contributors
+# SPDX-License-Identifier: Apache-2.0 OR MIT
+
+"""Stub benchmarks
+
+Runs the harnesses in tests/stub-benchmarks under each abstraction type and
+records the cost of verifying them, so the C-FFI, Kani and no-back models can
+be compared against the standard library collections.
+
+For every (file, harness, abstraction) the report contains the CBMC symex
+steps, formula variables and clauses, symex and solver time as reported by
+CBMC, the wall-clock time and the peak RSS of the run.
+
+With --baseline, the report is compared against an earlier one, and the runs
+whose symex steps or clauses grew by more than --tolerance percent are listed
+as regressions, e.g. to check a change to the stubs.
+
+Usage:
+    scripts/kani-stub-bench.py [--filter SUBSTRING] [--output report.json]
+                               [--baseline old-report.json] [--tolerance 10]
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+KANI_DIR = os.path.dirname(SCRIPT_DIR)
+BENCH_DIR = os.path.join(KANI_DIR, "tests", "stub-benchmarks")
+KANI = os.path.join(SCRIPT_DIR, "kani")
+
+# The abstractions that model each collection. `std` runs without --use-abs.
+# The benchmarks bring the model of the abstraction type into scope themselves,
+# from tests/stub-benchmarks/abstractions.rs.
+ABSTRACTIONS = {
+    "Vec": ["std", "kani", "no-back", "c-ffi"],
+    "HashSet": ["std", "c-ffi"],
+}
+
+# The statistics that --baseline compares. They are deterministic, unlike times.
+REGRESSION_STATS = ["symex_steps", "clauses"]
+
+# Harnesses are declared through `<kind>_bench!(name, size, unwind)`.
+HARNESS_RE = re.compile(r"^\w+_bench!\((\w+),\s*(\d+),", re.MULTILINE)
+
+CBMC_STATS = {
+    "symex_steps": (re.compile(r"size of program expression: (\d+) steps"), int),
+    "variables": (re.compile(r"(\d+) variables, \d+ clauses"), int),
+    "clauses": (re.compile(r"\d+ variables, (\d+) clauses"), int),
+    "symex_time": (re.compile(r"Runtime Symex: ([\d.]+)s"), float),
+    "solver_time": (re.compile(r"Runtime Solver: ([\d.]+)s"), float),
+}
+
+# The verdict, as printed by Kani or, with --output-format old, by CBMC.
+VERDICT_RE = re.compile(r"^VERIFICATION:?-? (SUCCESSFUL|FAILED)", re.MULTILINE)
+
+
+class BenchmarkError(Exception):
+    """A benchmark that did not get to verification, e.g. it failed to compile."""
+
+
+def find_harnesses():
+    for kind in sorted(ABSTRACTIONS):
+        kind_dir = os.path.join(BENCH_DIR, kind)
+        for name in sorted(os.listdir(kind_dir)):
+            if not name.endswith(".rs"):
+                continue
+            path = os.path.join(kind_dir, name)
+            with open(path) as f:
+                for harness, size in HARNESS_RE.findall(f.read()):
+                    yield kind, path, harness, int(size)
+
+
+def parse_cbmc_stats(output):
+    """Returns the last value CBMC printed for each statistic, or None."""
+    stats = {}
+    for key, (regex, convert) in CBMC_STATS.items():
+        values = regex.findall(output)
+        stats[key] = convert(values[-1]) if values else None
+    return stats
+
+
+def run_benchmark(path, harness, abs_type):
+    cmd = [KANI, path, "--harness", harness, "--output-format", "old"]
+    if abs_type != "std":
+        cmd += ["--use-abs", "--abs-type", abs_type]
+
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    output = proc.stdout.read()
+    # wait4 reports the resource usage of this run alone, including cbmc.
+    _, status, rusage = os.wait4(proc.pid, 0)
+    elapsed = time.monotonic() - start
+
+    verdicts = VERDICT_RE.findall(output)
+    if not verdicts:
+        raise BenchmarkError(f"{' '.join(cmd)} did not verify the harness:\n{output}")
+
+    result = {
+        "status": "success" if verdicts[-1] == "SUCCESSFUL" else "failure",
+        "wall_time": round(elapsed, 3),
+        # ru_maxrss is in kilobytes on Linux.
+        "peak_rss_kb": rusage.ru_maxrss,
+    }
+    result.update(parse_cbmc_stats(output))
+    return result
+
+
+def find_regressions(report, baseline, tolerance):
+    """Returns a description of each statistic in `report` that grew by more
+    than `tolerance` percent since the same run in `baseline`."""
+    previous = {(entry["file"], entry["harness"], entry["abs_type"]): entry
+                for entry in baseline}
+    regressions = []
+    for entry in report:
+        old = previous.get((entry["file"], entry["harness"], entry["abs_type"]))
+        if old is None:
+            continue
+        for stat in REGRESSION_STATS:
+            before, after = old.get(stat), entry.get(stat)
+            if before and after and after > before * (1 + tolerance / 100):
+                regressions.append(f"{entry['harness']} [{entry['abs_type']}]: "
+                                   f"{stat} went from {before} to {after}")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--filter", default="",
+                        help="only run harnesses whose name contains this string")
+    parser.add_argument("--output", default="stub-bench.json",
+                        help="where to write the JSON report")
+    parser.add_argument("--baseline",
+                        help="an earlier report to check this one against for regressions")
+    parser.add_argument("--tolerance", type=float, default=10,
+                        help="how many percent a statistic may grow before it is a regression")
+    args = parser.parse_args()
+
+    report = []
+    for kind, path, harness, size in find_harnesses():
+        if args.filter not in harness:
+            continue
+        for abs_type in ABSTRACTIONS[kind]:
+            print(f"{os.path.relpath(path, KANI_DIR)}::{harness} [{abs_type}]", flush=True)
+            entry = {
+                "file": os.path.relpath(path, KANI_DIR),
+                "harness": harness,
+                "size": size,
+                "abs_type": abs_type,
+            }
+            try:
+                entry.update(run_benchmark(path, harness, abs_type))
+            except BenchmarkError as error:
+                # Timings of a run that never verified anything would only skew the report.
+                print(error, file=sys.stderr)
+                return 2
+            print(f"    {entry['status']} in {entry['wall_time']}s, "
+                  f"{entry['clauses']} clauses, {entry['peak_rss_kb']} KB", flush=True)
+            report.append(entry)
+
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=2)
+    print(f"Wrote {len(report)} results to {args.output}")
+
+    regressions = []
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions = find_regressions(report, json.load(f), args.tolerance)
+        for regression in regressions:
+            print(f"Regression: {regression}")
+    if regressions or not all(entry["status"] == "success" for entry in report):
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
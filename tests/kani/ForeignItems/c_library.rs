@@ -0,0 +1,23 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Check that functions of the C library are modeled by CBMC, rather than reported as undefined
+//! functions: goto-instrument must add its library before it generates bodies for undefined
+//! functions.
+
+extern "C" {
+    fn strlen(s: *const u8) -> usize;
+    fn memcmp(a: *const u8, b: *const u8, n: usize) -> i32;
+}
+
+#[kani::proof]
+#[kani::unwind(6)]
+fn main() {
+    let s = b"kani\0";
+    assert!(unsafe { strlen(s.as_ptr()) } == 4);
+
+    let a = [1u8, 2, 3];
+    let b = [1u8, 2, 4];
+    assert!(unsafe { memcmp(a.as_ptr(), b.as_ptr(), 2) } == 0);
+    assert!(unsafe { memcmp(a.as_ptr(), b.as_ptr(), 3) } < 0);
+}
@@ -0,0 +1,45 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// Check that the goto binary that kani-compiler writes itself links and verifies, for a harness
+// whose bodies, statics and allocator calls all come from the converted symbol values.
+
+// kani-flags: --enable-unstable --write-goto-binary
+
+static GREETING: &str = "hello";
+static mut COUNTER: u32 = 0;
+
+trait Shape {
+    fn area(&self) -> u32;
+}
+
+struct Square(u32);
+
+impl Shape for Square {
+    fn area(&self) -> u32 {
+        self.0 * self.0
+    }
+}
+
+#[kani::proof]
+#[kani::unwind(4)]
+fn check_box_vec() {
+    let boxed: Box<dyn Shape> = Box::new(Square(3));
+    assert_eq!(boxed.area(), 9);
+
+    let mut v: Vec<u8> = Vec::new();
+    for b in GREETING.bytes().take(3) {
+        v.push(b);
+    }
+    assert_eq!(v.len(), 3);
+    assert_eq!(v[0], b'h');
+
+    let x: u8 = kani::any();
+    v[1] = x;
+    assert!(v[1] == x);
+
+    unsafe {
+        COUNTER += 1;
+        assert_eq!(COUNTER, 1);
+    }
+}
@@ -0,0 +1,25 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// Allocations honour the alignment requested by their layout
+
+use std::alloc::{alloc, alloc_zeroed, dealloc, realloc, Layout};
+
+#[kani::proof]
+fn main() {
+    unsafe {
+        let layout = Layout::from_size_align(24, 64).unwrap();
+        let ptr = alloc(layout);
+        assert_eq!(ptr as usize % 64, 0);
+
+        let zeroed = alloc_zeroed(layout);
+        assert_eq!(zeroed as usize % 64, 0);
+        assert_eq!(*zeroed, 0);
+
+        let ptr = realloc(ptr, layout, 48);
+        assert_eq!(ptr as usize % 64, 0);
+
+        dealloc(ptr, Layout::from_size_align(48, 64).unwrap());
+        dealloc(zeroed, layout);
+    }
+}
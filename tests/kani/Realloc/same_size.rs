@@ -0,0 +1,24 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// Realloc to the same size keeps the data and the allocation intact
+
+use std::alloc::{alloc, dealloc, realloc, Layout};
+
+#[kani::proof]
+fn main() {
+    unsafe {
+        let layout = Layout::array::<u32>(2).unwrap();
+        let ptr = alloc(layout);
+
+        *(ptr as *mut u32) = 19;
+        *(ptr as *mut u32).offset(1) = 83;
+
+        let ptr = realloc(ptr, layout, layout.size());
+
+        assert_eq!(*(ptr as *mut u32), 19);
+        assert_eq!(*(ptr as *mut u32).offset(1), 83);
+
+        dealloc(ptr, layout);
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// Check that each harness verifies from the slice of what it reaches, when what it reaches is
+// only referenced from statics, vtables, function pointers or the allocator shims.
+
+// kani-flags: --enable-unstable --slice-harnesses
+
+static TABLE: [(u8, u8); 3] = [(1, 2), (3, 4), (5, 6)];
+static mut CALLS: u32 = 0;
+static OPS: [fn(u32) -> u32; 2] = [double, increment];
+
+fn double(x: u32) -> u32 {
+    x * 2
+}
+
+fn increment(x: u32) -> u32 {
+    x + 1
+}
+
+trait Animal {
+    fn legs(&self) -> u32;
+}
+
+struct Bird;
+struct Cat;
+
+impl Animal for Bird {
+    fn legs(&self) -> u32 {
+        2
+    }
+}
+
+impl Animal for Cat {
+    fn legs(&self) -> u32 {
+        4
+    }
+}
+
+#[kani::proof]
+fn check_statics() {
+    let index: usize = kani::any();
+    kani::assume(index < TABLE.len());
+    let (key, value) = TABLE[index];
+    assert_eq!(key + 1, value);
+    unsafe {
+        CALLS += 1;
+        assert_eq!(CALLS, 1);
+    }
+}
+
+#[kani::proof]
+fn check_function_pointers() {
+    let op = if kani::any() { OPS[0] } else { OPS[1] };
+    let x: u32 = kani::any();
+    kani::assume(x < 100);
+    assert!(op(x) > x || x == 0);
+}
+
+#[kani::proof]
+fn check_vtables() {
+    let animal: &dyn Animal = if kani::any() { &Bird } else { &Cat };
+    let legs = animal.legs();
+    assert!(legs == 2 || legs == 4);
+}
+
+#[kani::proof]
+#[kani::unwind(3)]
+fn check_allocation() {
+    let boxed: Box<dyn Animal> = Box::new(Cat);
+    assert_eq!(boxed.legs(), 4);
+    let mut v = Vec::with_capacity(2);
+    v.push(kani::any::<u8>());
+    v.push(1);
+    assert_eq!(v.len(), 2);
+    assert_eq!(v[1], 1);
+}
@@ -0,0 +1,48 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// Inserts K nondeterministic keys, checks them and removes them again.
+// Run through scripts/kani-stub-bench.py.
+
+#[cfg(use_abs)]
+#[path = "../abstractions.rs"]
+mod abstractions;
+#[cfg(use_abs)]
+use abstractions::hashset::HashSet;
+#[cfg(not(use_abs))]
+use std::collections::HashSet;
+
+macro_rules! insert_remove_bench {
+    ($name:ident, $k:literal, $unwind:literal) => {
+        #[kani::proof]
+        #[kani::unwind($unwind)]
+        fn $name() {
+            let mut set: HashSet<u16> = HashSet::new();
+            let keys: [u16; $k] = kani::any();
+            let mut i = 0;
+            while i < $k {
+                set.insert(keys[i]);
+                i += 1;
+            }
+            i = 0;
+            while i < $k {
+                assert!(set.contains(&keys[i]));
+                i += 1;
+            }
+            i = 0;
+            while i < $k {
+                // The model only holds u16 keys, and takes them by value.
+                #[cfg(use_abs)]
+                set.remove(keys[i]);
+                #[cfg(not(use_abs))]
+                set.remove(&keys[i]);
+                assert!(!set.contains(&keys[i]));
+                i += 1;
+            }
+        }
+    };
+}
+
+insert_remove_bench!(insert_remove_4, 4, 5);
+insert_remove_bench!(insert_remove_16, 16, 17);
+insert_remove_bench!(insert_remove_64, 64, 65);
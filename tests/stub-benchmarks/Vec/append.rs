@@ -0,0 +1,35 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// Appends a vector of N elements to another one of N elements.
+// Run through scripts/kani-stub-bench.py.
+
+#[cfg(use_abs)]
+#[path = "../abstractions.rs"]
+mod abstractions;
+#[cfg(use_abs)]
+use abstractions::vec::Vec;
+
+macro_rules! append_bench {
+    ($name:ident, $n:literal, $unwind:literal) => {
+        #[kani::proof]
+        #[kani::unwind($unwind)]
+        fn $name() {
+            let mut v1: Vec<u32> = Vec::new();
+            let mut v2: Vec<u32> = Vec::new();
+            let mut i = 0;
+            while i < $n {
+                v1.push(kani::any());
+                v2.push(kani::any());
+                i += 1;
+            }
+            v1.append(&mut v2);
+            assert!(v1.len() == 2 * $n);
+            assert!(v2.len() == 0);
+        }
+    };
+}
+
+append_bench!(append_8, 8, 17);
+append_bench!(append_32, 32, 65);
+append_bench!(append_128, 128, 257);
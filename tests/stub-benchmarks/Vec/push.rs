@@ -0,0 +1,36 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// Pushes N nondeterministic elements and pops them back.
+// Run through scripts/kani-stub-bench.py.
+
+#[cfg(use_abs)]
+#[path = "../abstractions.rs"]
+mod abstractions;
+#[cfg(use_abs)]
+use abstractions::vec::Vec;
+
+macro_rules! push_bench {
+    ($name:ident, $n:literal, $unwind:literal) => {
+        #[kani::proof]
+        #[kani::unwind($unwind)]
+        fn $name() {
+            let mut v: Vec<u32> = Vec::new();
+            let mut i = 0;
+            while i < $n {
+                v.push(kani::any());
+                i += 1;
+            }
+            assert!(v.len() == $n);
+            while i > 0 {
+                assert!(v.pop().is_some());
+                i -= 1;
+            }
+            assert!(v.pop().is_none());
+        }
+    };
+}
+
+push_bench!(push_8, 8, 9);
+push_bench!(push_32, 32, 33);
+push_bench!(push_128, 128, 129);
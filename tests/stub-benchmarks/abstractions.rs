@@ -0,0 +1,22 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// The models of the collections in library/kani/stubs/Rust, for the abstraction type that
+// `--use-abs --abs-type <type>` selects. The benchmarks include this module under `use_abs` and
+// use its collections in place of the standard library ones.
+
+#[cfg(abs_type = "kani")]
+#[path = "../../library/kani/stubs/Rust/vec/kani_vec.rs"]
+pub mod vec;
+
+#[cfg(abs_type = "c-ffi")]
+#[path = "../../library/kani/stubs/Rust/vec/c_vec.rs"]
+pub mod vec;
+
+#[cfg(abs_type = "no-back")]
+#[path = "../../library/kani/stubs/Rust/vec/noback_vec.rs"]
+pub mod vec;
+
+#[cfg(abs_type = "c-ffi")]
+#[path = "../../library/kani/stubs/Rust/hashset/c_hashset.rs"]
+pub mod hashset;
@@ -0,0 +1,24 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// kani-flags: --use-abs --abs-type c-ffi
+fn main() {
+    let mut v: BytesVec<(u8, u64)> = BytesVec::new();
+    v.push((1, 10));
+    v.push((2, 20));
+    assert!(v.len() == 2);
+    assert!(v.pop() == Some((2, 20)));
+
+    let mut w: BytesVec<(u8, u64)> = BytesVec::with_capacity(1);
+    w.push((3, 30));
+    w.push((4, 40));
+    assert!(w.capacity() >= 2);
+
+    v.append(&mut w);
+    assert!(v.len() == 3);
+    assert!(w.len() == 0);
+    assert!(v.pop() == Some((4, 40)));
+    assert!(v.pop() == Some((3, 30)));
+    assert!(v.pop() == Some((1, 10)));
+    assert!(v.pop() == None);
+}
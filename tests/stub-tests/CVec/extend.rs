@@ -0,0 +1,32 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// kani-flags: --use-abs --abs-type c-ffi
+fn main() {
+    let mut v: Vec<u32> = Vec::from(&[1, 2][..]);
+    assert!(v.len() == 2);
+
+    v.extend_from_slice(&[3, 4, 5]);
+    assert!(v.len() == 5);
+
+    // A reservation which fits the current capacity does not grow the Vector.
+    let cap = v.capacity();
+    v.reserve(cap - v.len());
+    assert!(v.capacity() == cap);
+
+    v.extend([6, 7].iter());
+    v.extend(Some(8));
+    assert!(v.len() == 8);
+
+    let mut other: Vec<u32> = Vec::from(&[9][..]);
+    v.append(&mut other);
+    assert!(v.len() == 9);
+    assert!(other.len() == 0);
+
+    let mut expected = 9;
+    while let Some(elem) = v.pop() {
+        assert!(elem == expected);
+        expected -= 1;
+    }
+    assert!(expected == 0);
+}
@@ -0,0 +1,14 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// kani-flags: --use-abs --abs-type c-ffi
+fn main() {
+    let mut v: Vec<u32> = Vec::with_capacity(1);
+    v.push(1);
+    v.push(2);
+    v.push(3);
+    assert!(v.capacity() >= 3);
+    assert!(v.pop() == Some(3));
+    assert!(v.pop() == Some(2));
+    assert!(v.pop() == Some(1));
+}
@@ -0,0 +1,25 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// kani-flags: --use-abs --abs-type c-ffi --c-ffi-symbolic-capacity
+#[kani::proof]
+#[kani::vec_capacity(4)]
+fn main() {
+    let mut v: Vec<u32> = Vec::new();
+    assert!(v.capacity() <= 4);
+
+    // Depending on the initial capacity, these pushes grow the Vector zero or
+    // more times.
+    v.push(1);
+    v.push(2);
+    v.push(3);
+    assert!(v.capacity() >= 3);
+
+    let w: Vec<u32> = Vec::with_capacity(2);
+    assert!(w.capacity() >= 2 && w.capacity() <= 4);
+
+    assert!(v.pop() == Some(3));
+    assert!(v.pop() == Some(2));
+    assert!(v.pop() == Some(1));
+    assert!(v.pop() == None);
+}
@@ -0,0 +1,30 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// kani-flags: --use-abs --abs-type c-ffi
+fn main() {
+    let mut pairs: BytesHashSet<(u32, u32)> = BytesHashSet::new();
+    assert!(pairs.insert((1, 2)));
+    assert!(pairs.insert((2, 1)));
+    assert!(!pairs.insert((1, 2)));
+    assert!(pairs.contains(&(1, 2)));
+    assert!(!pairs.contains(&(1, 1)));
+    assert!(pairs.remove(&(1, 2)));
+    assert!(!pairs.contains(&(1, 2)));
+    assert!(pairs.contains(&(2, 1)));
+    assert!(pairs.len() == 1);
+
+    let mut names: BytesHashSet<String> = BytesHashSet::new();
+    assert!(names.insert(String::from("vsock")));
+    assert!(names.insert(String::from("vso")));
+    assert!(names.contains(&String::from("vsock")));
+    assert!(!names.contains(&String::from("vs")));
+    assert!(names.remove(&String::from("vso")));
+    assert!(!names.remove(&String::from("vso")));
+    assert!(names.len() == 1);
+
+    // The length prefix keeps the split between the elements of a tuple.
+    let mut split: BytesHashSet<(&str, &str)> = BytesHashSet::new();
+    assert!(split.insert(("ab", "c")));
+    assert!(!split.contains(&("a", "bc")));
+}
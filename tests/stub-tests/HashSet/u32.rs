@@ -0,0 +1,18 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// kani-flags: --use-abs --abs-type c-ffi
+fn main() {
+    let mut h: HashSetU32<u32> = HashSetU32::new();
+
+    assert!(h.insert(5));
+    assert!(h.contains(&5));
+    assert!(!h.contains(&(5 + (1 << 16))));
+    assert!(h.insert(u32::MAX));
+    assert!(h.contains(&u32::MAX));
+    assert!(!h.insert(u32::MAX));
+    assert!(h.remove(5));
+    assert!(!h.contains(&5));
+    assert!(!h.remove(5));
+    assert!(!h.remove(1 << 20));
+}
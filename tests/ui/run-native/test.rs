@@ -0,0 +1,22 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+// kani-flags: --enable-unstable --run-native --native-iterations 200 --native-seed 1
+
+//! Check that --run-native runs each harness for the given iterations, rejects the iterations
+//! whose assumptions don't hold, and reports the seed of a failing one.
+
+#[kani::proof]
+fn check_even_passes() {
+    let x: u8 = kani::any();
+    kani::assume(x % 2 == 0);
+    assert!(x != 1);
+}
+
+#[kani::proof]
+fn check_zero_fails() {
+    let x: u8 = kani::any();
+    assert!(x != 0);
+}
+
+fn main() {}
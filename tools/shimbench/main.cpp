@@ -0,0 +1,297 @@
+// Copyright Kani Contributors
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+// Benchmarks the runtime shims of library/kani/gen_c_lib.c, which the code
+// generated by --gen-c-runnable is compiled against, and the harnesses of the
+// concrete-run mode (--run-native):
+//
+//   g++ -std=gnu++17 -O2 -o shimbench main.cpp
+//   ./shimbench [FILE.c:HARNESS ...]
+//
+// Each shim is first checked against a hand-written equivalent on the same
+// inputs, including the byte order that the host does not use, so the
+// extraction of other targets is checked too. Then both are timed, in ns/op.
+//
+// Each FILE.c:HARNESS is C generated with --gen-c-runnable (e.g. kept with
+// --keep-temps) and the mangled name of a harness in it. It is compiled like
+// --run-native does, with $CC or cc, and timed in ns per iteration of the run
+// mode, without the cost of starting the process.
+//
+// Run it from this directory, or build with -DGEN_C_LIB=<path of gen_c_lib.c>.
+#ifndef GEN_C_LIB
+#define GEN_C_LIB "../../library/kani/gen_c_lib.c"
+#endif
+
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// The shims are macros, so they are only usable by including the file.
+#include GEN_C_LIB
+
+// Keeps the compiler from folding or discarding a value the benchmark computes.
+template <typename T> static inline void keep(T &value) { asm volatile("" : "+r"(value)); }
+static inline void keep(double &value) { asm volatile("" : "+m"(value)); }
+static inline void keep(float &value) { asm volatile("" : "+m"(value)); }
+
+// Inputs are taken from a table of random values, so the operations can't be
+// computed at compile time, and the table fits in the L1 cache.
+constexpr size_t INPUTS = 1024;
+constexpr size_t ROUNDS = 20000;
+
+static uint64_t inputs[ INPUTS ];
+
+static void fill_inputs()
+{
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    for (size_t i = 0; i < INPUTS; i++) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        inputs[ i ] = state * 0x9E3779B97F4A7C15ull;
+    }
+    // The boundaries, where overflows happen.
+    inputs[ 0 ] = 0;
+    inputs[ 1 ] = 1;
+    inputs[ 2 ] = UINT64_MAX;
+    inputs[ 3 ] = uint64_t(INT64_MAX);
+    inputs[ 4 ] = uint64_t(INT64_MIN);
+    inputs[ 5 ] = uint64_t(INT32_MAX);
+    inputs[ 6 ] = uint64_t(uint32_t(INT32_MIN));
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, size_t i)
+{
+    if (!ok && failures++ < 10) {
+        std::cerr << what << " differs from the hand-written version on input " << i << std::endl;
+    }
+}
+
+// The hand-written equivalents of the shims.
+static bool add_overflows_i32(int32_t a, int32_t b) { return b > 0 ? a > INT32_MAX - b : a < INT32_MIN - b; }
+
+static bool sub_overflows_i64(int64_t a, int64_t b) { return b < 0 ? a > INT64_MAX + b : a < INT64_MIN + b; }
+
+static bool mul_overflows_u64(uint64_t a, uint64_t b) { return a != 0 && b > UINT64_MAX / a; }
+
+// Bytes `offset` to `offset + 3` of `value` in little (or big) endian order, by shifts, so
+// independent of the host.
+static uint32_t extract_u32_le(uint64_t value, size_t offset) { return uint32_t(value >> (8 * offset)); }
+
+static uint32_t extract_u32_be(uint64_t value, size_t offset) { return uint32_t(value >> (8 * (4 - offset))); }
+
+// Exponentiation by squaring, as LLVM defines `powi`.
+static double powi_by_squaring(double base, int expt)
+{
+    unsigned n      = expt < 0 ? 0u - unsigned(expt) : unsigned(expt);
+    double   result = 1.0;
+    while (n != 0) {
+        if (n & 1) { result *= base; }
+        base *= base;
+        n >>= 1;
+    }
+    return expt < 0 ? 1.0 / result : result;
+}
+
+static bool close(double a, double b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b)) || std::fabs(a - b) <= 1e-9 * std::fabs(b);
+}
+
+// Small exponents and bases near 1, as in the code being verified, so the powers stay finite.
+static double base_of(uint64_t input) { return 0.5 + double(input >> 11) / double(1ull << 53); }
+
+static int expt_of(uint64_t input) { return int(input % 41) - 20; }
+
+static void check_shims()
+{
+    for (size_t i = 0; i < INPUTS; i++) {
+        uint64_t a = inputs[ i ];
+        uint64_t b = inputs[ (i * 7 + 3) % INPUTS ];
+        check(overflow("+", int32_t, int32_t(a), int32_t(b)) == add_overflows_i32(int32_t(a), int32_t(b)),
+              "overflow(\"+\", int32_t)", i);
+        check(overflow("-", int64_t, int64_t(a), int64_t(b)) == sub_overflows_i64(int64_t(a), int64_t(b)),
+              "overflow(\"-\", int64_t)", i);
+        check(overflow("*", uint64_t, a, b) == mul_overflows_u64(a, b), "overflow(\"*\", uint64_t)", i);
+        // Small factors too, since large random ones always overflow.
+        check(overflow("*", uint64_t, a >> 40, b >> 40) == mul_overflows_u64(a >> 40, b >> 40),
+              "overflow(\"*\", uint64_t)", i);
+
+        size_t offset = i % 5;
+        // Both byte orders extract from the value as the host stores it. The one the host does
+        // not use takes the byte-swapping path of the targets of the other byte order.
+        check(byte_extract_little_endian(a, offset, uint32_t) == extract_u32_le(a, offset),
+              "byte_extract_little_endian", i);
+        check(byte_extract_big_endian(a, offset, uint32_t) == extract_u32_be(a, offset), "byte_extract_big_endian",
+              i);
+
+        double base = base_of(a);
+        int    expt = expt_of(b);
+        check(close(powi(base, expt), powi_by_squaring(base, expt)), "powi", i);
+        check(close(powif(float(base), expt), float(powi_by_squaring(float(base), expt))), "powif", i);
+    }
+}
+
+// Times `op` on each input, ROUNDS times, in ns per call.
+template <typename Op> static double time_ns(Op op)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < INPUTS; i++) { op(i); }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / double(ROUNDS * INPUTS);
+}
+
+template <typename Shim, typename Hand> static void bench(const char *name, Shim shim, Hand hand)
+{
+    double shim_ns = time_ns(shim);
+    double hand_ns = time_ns(hand);
+    std::printf("%-36s %8.3f %8.3f %7.2fx\n", name, shim_ns, hand_ns, shim_ns / hand_ns);
+}
+
+static void bench_shims()
+{
+    std::printf("%-36s %8s %8s %8s\n", "shim (ns/op)", "gen_c", "by hand", "ratio");
+    bench(
+        "overflow(\"+\", int32_t)",
+        [](size_t i) {
+            bool r = overflow("+", int32_t, int32_t(inputs[ i ]), int32_t(inputs[ (i + 1) % INPUTS ]));
+            keep(r);
+        },
+        [](size_t i) {
+            bool r = add_overflows_i32(int32_t(inputs[ i ]), int32_t(inputs[ (i + 1) % INPUTS ]));
+            keep(r);
+        });
+    bench(
+        "overflow(\"-\", int64_t)",
+        [](size_t i) {
+            bool r = overflow("-", int64_t, int64_t(inputs[ i ]), int64_t(inputs[ (i + 1) % INPUTS ]));
+            keep(r);
+        },
+        [](size_t i) {
+            bool r = sub_overflows_i64(int64_t(inputs[ i ]), int64_t(inputs[ (i + 1) % INPUTS ]));
+            keep(r);
+        });
+    bench(
+        "overflow(\"*\", uint64_t)",
+        [](size_t i) {
+            bool r = overflow("*", uint64_t, inputs[ i ] >> 40, inputs[ (i + 1) % INPUTS ] >> 40);
+            keep(r);
+        },
+        [](size_t i) {
+            bool r = mul_overflows_u64(inputs[ i ] >> 40, inputs[ (i + 1) % INPUTS ] >> 40);
+            keep(r);
+        });
+    bench(
+        "byte_extract_little_endian(u64, u32)",
+        [](size_t i) {
+            uint32_t r = byte_extract_little_endian(inputs[ i ], i % 5, uint32_t);
+            keep(r);
+        },
+        [](size_t i) {
+            uint32_t r = extract_u32_le(inputs[ i ], i % 5);
+            keep(r);
+        });
+    bench(
+        "byte_extract_big_endian(u64, u32)",
+        [](size_t i) {
+            uint32_t r = byte_extract_big_endian(inputs[ i ], i % 5, uint32_t);
+            keep(r);
+        },
+        [](size_t i) {
+            uint32_t r = extract_u32_be(inputs[ i ], i % 5);
+            keep(r);
+        });
+    bench(
+        "powi",
+        [](size_t i) {
+            double r = powi(base_of(inputs[ i ]), expt_of(inputs[ (i + 1) % INPUTS ]));
+            keep(r);
+        },
+        [](size_t i) {
+            double r = powi_by_squaring(base_of(inputs[ i ]), expt_of(inputs[ (i + 1) % INPUTS ]));
+            keep(r);
+        });
+    bench(
+        "powif",
+        [](size_t i) {
+            float r = powif(float(base_of(inputs[ i ])), expt_of(inputs[ (i + 1) % INPUTS ]));
+            keep(r);
+        },
+        [](size_t i) {
+            float r = float(powi_by_squaring(float(base_of(inputs[ i ])), expt_of(inputs[ (i + 1) % INPUTS ])));
+            keep(r);
+        });
+}
+
+// Iterations of the run mode to time each harness with.
+constexpr unsigned long long HARNESS_ITERATIONS = 100000;
+
+// Runs `command`, and returns how long it took in ns, or a negative value if it failed.
+static double run_ns(const std::string &command)
+{
+    auto start  = std::chrono::steady_clock::now();
+    int  status = std::system(command.c_str());
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return status == 0 ? elapsed.count() : -1.0;
+}
+
+// Compiles and times the harness of `spec`, `FILE.c:HARNESS`. Returns whether it ran.
+static bool bench_harness(const std::string &spec)
+{
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) {
+        std::cerr << spec << ": expected FILE.c:HARNESS" << std::endl;
+        return false;
+    }
+    std::string file       = spec.substr(0, colon);
+    std::string harness    = spec.substr(colon + 1);
+    std::string executable = file + "." + harness + ".bench";
+    const char *cc         = std::getenv("CC") != nullptr ? std::getenv("CC") : "cc";
+
+    // The same command as --run-native.
+    std::string compile = std::string(cc) + " -O2 -include " GEN_C_LIB " -DKANI_HARNESS=" + harness + " '" + file +
+                          "' -o '" + executable + "' -lm";
+    if (std::system(compile.c_str()) != 0) {
+        std::cerr << spec << ": failed to compile" << std::endl;
+        return false;
+    }
+
+    // Running no iterations measures the cost of starting the process, which is subtracted.
+    std::string run     = std::string(executable[ 0 ] == '/' ? "'" : "'./") + executable + "' ";
+    double      startup = run_ns(run + "0 > /dev/null");
+    double      total   = run_ns(run + std::to_string(HARNESS_ITERATIONS) + " > /dev/null");
+    std::remove(executable.c_str());
+    if (startup < 0 || total < 0) {
+        std::cerr << spec << ": the harness failed" << std::endl;
+        return false;
+    }
+    std::printf("%-36s %8.1f\n", harness.c_str(), (total - startup) / double(HARNESS_ITERATIONS));
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    fill_inputs();
+    check_shims();
+    if (failures > 0) {
+        std::cerr << failures << " checks of the shims failed" << std::endl;
+        return 1;
+    }
+    bench_shims();
+
+    bool ok = true;
+    if (argc > 1) {
+        std::printf("\n%-36s %8s\n", "harness (ns/iteration)", "run mode");
+        for (int i = 1; i < argc; i++) { ok = bench_harness(argv[ i ]) && ok; }
+    }
+    return ok ? 0 : 1;
+}
@@ -1,28 +1,152 @@
 // Copyright Kani Contributors
 // SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+// Generates cprover_bindings/src/machine_model/targets.rs, the table of
+// arch-dependent constants for `MachineModel`:
+//
+//   g++ -std=c++17 -o sizeofs main.cpp
+//   ./sizeofs > ../../cprover_bindings/src/machine_model/targets.rs
+//
+// The models of all supported targets are listed below, so the file can be
+// generated from any host. Building on one of the supported targets checks the
+// corresponding entry against what the compiler actually uses.
+#include <cfloat>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <type_traits>
- 
- // generates the arch-dependent constants for MachineModel
-int main() 
-{    
-    std::cout << "let bool_width = " << sizeof(bool)*8 << ";" << std::endl;
-    std::cout << "let char_is_unsigned = " << (std::is_unsigned<bool>::value?"true":"false") << ";" << std::endl;
-    std::cout << "let char_width = " << sizeof(char)*8 << ";" << std::endl;   
-    std::cout << "let double_width = " << sizeof(double)*8 << ";" << std::endl;
-    std::cout << "let float_width = " << sizeof(float)*8 << ";" << std::endl;
-    std::cout << "let int_width = " << sizeof(int)*8 << ";" << std::endl;
-    std::cout << "let long_double_width = " << sizeof(long double)*8 << ";" << std::endl;
-    std::cout << "let long_int_width = " << sizeof(long int)*8 << ";" << std::endl;
-    std::cout << "let long_long_int_width = " << sizeof(long long int)*8 << ";" << std::endl;
-    // memory_operand_size
-    // null_is_zero 
-    std::cout << "let short_int_width = " << sizeof(short int)*8 << ";" << std::endl;
-    std::cout << "let single_width = " << sizeof(float)*8 << ";" << std::endl;
-    std::cout << "let wchar_t_is_unsigned = " << (std::is_unsigned<wchar_t>::value?"true":"false") << ";" << std::endl;
-    std::cout << "let wchar_t_width = " << sizeof(wchar_t)*8 << ";" << std::endl;    
-    // word_size
-    // rounding_mode    
+
+// Mirrors `cprover_bindings::MachineModel` field by field.
+struct machine_model
+{
+    const char *fn_name;
+    const char *architecture;
+    uint64_t    alignment;
+    uint64_t    bool_width;
+    bool        char_is_unsigned;
+    uint64_t    char_width;
+    uint64_t    double_width;
+    uint64_t    float_width;
+    uint64_t    int_width;
+    bool        is_big_endian;
+    uint64_t    long_double_width;
+    uint64_t    long_int_width;
+    uint64_t    long_long_int_width;
+    uint64_t    memory_operand_size;
+    bool        null_is_zero;
+    uint64_t    pointer_width;
+    const char *rounding_mode;
+    uint64_t    short_int_width;
+    uint64_t    single_width;
+    bool        wchar_t_is_unsigned;
+    uint64_t    wchar_t_width;
+    uint64_t    word_size;
+};
+
+// For reference, the definition in CBMC:
+// https://github.com/diffblue/cbmc/blob/develop/src/util/config.cpp
+// `word_size` and `memory_operand_size` follow CBMC and are derived from the
+// width of `int`.
+constexpr machine_model targets[] = {
+    // x86_64-unknown-linux-gnu and x86_64-apple-darwin (System V ABI)
+    {"x86_64", "x86_64", 1, 8, false, 8, 64, 32, 32, false, 128, 64, 64, 4, true, 64, "ToNearest", 16, 32, false, 32, 32},
+    // aarch64-apple-darwin, where `char` is signed and `long double` is `double`
+    {"aarch64", "aarch64", 1, 8, false, 8, 64, 32, 32, false, 64, 64, 64, 4, true, 64, "ToNearest", 16, 32, false, 32, 32},
+};
+
+constexpr const char *host_architecture()
+{
+#if defined(__x86_64__)
+    return "x86_64";
+#elif defined(__aarch64__) && defined(__APPLE__)
+    return "aarch64";
+#else
+    return nullptr;
+#endif
+}
+
+constexpr bool same_name(const char *a, const char *b)
+{
+    while (*a != '\0' && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// Index of the host in `targets`, or -1 if the host is not a supported target.
+constexpr int host_index()
+{
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[ 0 ]); i++) {
+        if (host_architecture() != nullptr && same_name(targets[ i ].architecture, host_architecture())) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
 }
 
- 
\ No newline at end of file
+constexpr uint64_t width_of(uint64_t size) { return size * CHAR_BIT; }
+
+constexpr bool matches_host(const machine_model &m)
+{
+    return m.bool_width == width_of(sizeof(bool)) && m.char_is_unsigned == std::is_unsigned<char>::value &&
+           m.char_width == width_of(sizeof(char)) && m.double_width == width_of(sizeof(double)) &&
+           m.float_width == width_of(sizeof(float)) && m.int_width == width_of(sizeof(int)) &&
+           m.is_big_endian == (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__) &&
+           m.long_double_width == width_of(sizeof(long double)) && m.long_int_width == width_of(sizeof(long int)) &&
+           m.long_long_int_width == width_of(sizeof(long long int)) &&
+           m.memory_operand_size == sizeof(int) && m.pointer_width == width_of(sizeof(void *)) &&
+           m.short_int_width == width_of(sizeof(short int)) && m.single_width == width_of(sizeof(float)) &&
+           m.wchar_t_is_unsigned == std::is_unsigned<wchar_t>::value &&
+           m.wchar_t_width == width_of(sizeof(wchar_t)) && m.word_size == width_of(sizeof(int));
+}
+
+static_assert(host_index() < 0 || matches_host(targets[ host_index() ]),
+              "the machine model of the host does not match the compiler's");
+
+static const char *rust_bool(bool value) { return value ? "true" : "false"; }
+
+int main()
+{
+    // FLT_ROUNDS is not a constant expression, so the rounding mode is checked here.
+    if (host_index() >= 0 && (FLT_ROUNDS != 1 || std::strcmp(targets[ host_index() ].rounding_mode, "ToNearest") != 0)) {
+        std::cerr << "the rounding mode of the host does not match its machine model" << std::endl;
+        return 1;
+    }
+
+    std::cout << "// Copyright Kani Contributors" << std::endl;
+    std::cout << "// SPDX-License-Identifier: Apache-2.0 OR MIT" << std::endl;
+    std::cout << "//! The machine models of the supported targets." << std::endl;
+    std::cout << "//! This file is generated by tools/sizeofs/main.cpp; do not edit it by hand." << std::endl;
+    std::cout << std::endl;
+    std::cout << "use super::{MachineModel, RoundingMode};" << std::endl;
+    for (const machine_model &m : targets) {
+        std::cout << std::endl;
+        std::cout << "pub fn " << m.fn_name << "() -> MachineModel {" << std::endl;
+        std::cout << "    MachineModel {" << std::endl;
+        std::cout << "        alignment: " << m.alignment << "," << std::endl;
+        std::cout << "        architecture: \"" << m.architecture << "\".to_string()," << std::endl;
+        std::cout << "        bool_width: " << m.bool_width << "," << std::endl;
+        std::cout << "        char_is_unsigned: " << rust_bool(m.char_is_unsigned) << "," << std::endl;
+        std::cout << "        char_width: " << m.char_width << "," << std::endl;
+        std::cout << "        double_width: " << m.double_width << "," << std::endl;
+        std::cout << "        float_width: " << m.float_width << "," << std::endl;
+        std::cout << "        int_width: " << m.int_width << "," << std::endl;
+        std::cout << "        is_big_endian: " << rust_bool(m.is_big_endian) << "," << std::endl;
+        std::cout << "        long_double_width: " << m.long_double_width << "," << std::endl;
+        std::cout << "        long_int_width: " << m.long_int_width << "," << std::endl;
+        std::cout << "        long_long_int_width: " << m.long_long_int_width << "," << std::endl;
+        std::cout << "        memory_operand_size: " << m.memory_operand_size << "," << std::endl;
+        std::cout << "        null_is_zero: " << rust_bool(m.null_is_zero) << "," << std::endl;
+        std::cout << "        pointer_width: " << m.pointer_width << "," << std::endl;
+        std::cout << "        rounding_mode: RoundingMode::" << m.rounding_mode << "," << std::endl;
+        std::cout << "        short_int_width: " << m.short_int_width << "," << std::endl;
+        std::cout << "        single_width: " << m.single_width << "," << std::endl;
+        std::cout << "        wchar_t_is_unsigned: " << rust_bool(m.wchar_t_is_unsigned) << "," << std::endl;
+        std::cout << "        wchar_t_width: " << m.wchar_t_width << "," << std::endl;
+        std::cout << "        word_size: " << m.word_size << "," << std::endl;
+        std::cout << "    }" << std::endl;
+        std::cout << "}" << std::endl;
+    }
+}